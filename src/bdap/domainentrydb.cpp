@@ -9,6 +9,7 @@
 #include "bdap/fees.h"
 #include "coins.h"
 #include "bdap/utils.h"
+#include "dht/limits.h"
 #include "utilmoneystr.h"
 #include "utiltime.h"
 #include "validation.h"
@@ -18,6 +19,19 @@
 
 #include <boost/thread.hpp>
 
+#include <set>
+
+// Secondary indexes hold keys only, each key ends with the entry's full object path
+static const std::string DB_LOCATION_INDEX = "lo"; // (object location, object type), path
+static const std::string DB_TYPE_INDEX = "ty"; // object type, path
+static const std::string DB_SEARCH_INDEX = "ng"; // ObjectID or CommonName substring, path
+static const std::string DB_EXPIRE_INDEX = "ex"; // CDomainEntryExpireKey
+static const std::string DB_INDEX_VERSION = "iv";
+static const int CURRENT_INDEX_VERSION = 2;
+
+typedef std::pair<std::pair<CharString, unsigned int>, CharString> LocationIndexKey;
+typedef std::pair<unsigned int, CharString> TypeIndexKey;
+typedef std::pair<CharString, CharString> SearchIndexKey;
 
 CDomainEntryDB *pDomainEntryDB = NULL;
 
@@ -87,16 +101,65 @@ bool UndoDeleteDomainEntry(const CDomainEntry& entry)
     return false;
 }
 
+// Every BDAP_SEARCH_GRAM_LENGTH long substring of the entry's ObjectID and CommonName
+static std::set<CharString> GetSearchGrams(const CDomainEntry& entry)
+{
+    std::set<CharString> setGrams;
+    for (const CharString& vchField : {entry.ObjectID, entry.CommonName}) {
+        for (size_t i = 0; i + BDAP_SEARCH_GRAM_LENGTH <= vchField.size(); i++)
+            setGrams.insert(CharString(vchField.begin() + i, vchField.begin() + i + BDAP_SEARCH_GRAM_LENGTH));
+    }
+    return setGrams;
+}
+
+static bool MatchesSearch(const CDomainEntry& entry, const std::string& searchString)
+{
+    std::string compareString(entry.ObjectID.begin(), entry.ObjectID.end());
+    std::string compareCommonString(entry.CommonName.begin(), entry.CommonName.end());
+    return compareString.find(searchString) != std::string::npos || compareCommonString.find(searchString) != std::string::npos;
+}
+
+void CDomainEntryDB::WriteEntryIndexes(CDBBatch& batch, const CDomainEntry& entry)
+{
+    const CharString vchPath = entry.vchFullObjectPath();
+    batch.Write(make_pair(DB_LOCATION_INDEX, LocationIndexKey(std::make_pair(entry.vchObjectLocation(), entry.nObjectType), vchPath)), CharString());
+    batch.Write(make_pair(DB_TYPE_INDEX, TypeIndexKey(entry.nObjectType, vchPath)), CharString());
+    batch.Write(make_pair(DB_EXPIRE_INDEX, CDomainEntryExpireKey(entry.nExpireTime, vchPath)), CharString());
+    for (const CharString& vchGram : GetSearchGrams(entry))
+        batch.Write(make_pair(DB_SEARCH_INDEX, SearchIndexKey(vchGram, vchPath)), CharString());
+}
+
+void CDomainEntryDB::EraseEntryIndexes(CDBBatch& batch, const CDomainEntry& entry)
+{
+    const CharString vchPath = entry.vchFullObjectPath();
+    batch.Erase(make_pair(DB_LOCATION_INDEX, LocationIndexKey(std::make_pair(entry.vchObjectLocation(), entry.nObjectType), vchPath)));
+    batch.Erase(make_pair(DB_TYPE_INDEX, TypeIndexKey(entry.nObjectType, vchPath)));
+    batch.Erase(make_pair(DB_EXPIRE_INDEX, CDomainEntryExpireKey(entry.nExpireTime, vchPath)));
+    for (const CharString& vchGram : GetSearchGrams(entry))
+        batch.Erase(make_pair(DB_SEARCH_INDEX, SearchIndexKey(vchGram, vchPath)));
+}
+
 bool CDomainEntryDB::AddDomainEntry(const CDomainEntry& entry, const int op) 
 { 
     bool writeState = false;
     {
         LOCK(cs_bdap_entry);
-        writeState = Write(make_pair(std::string("dc"), entry.vchFullObjectPath()), entry) 
-                         && Write(make_pair(std::string("pk"), entry.DHTPublicKey), entry);
+        CDBBatch batch(*this);
+        // drop the index keys of an entry previously written to the same path
+        CDomainEntry prevEntry;
+        if (ReadDomainEntry(entry.vchFullObjectPath(), prevEntry))
+            EraseEntryIndexes(batch, prevEntry);
+        batch.Write(make_pair(std::string("dc"), entry.vchFullObjectPath()), entry);
+        batch.Write(make_pair(std::string("pk"), entry.DHTPublicKey), entry);
+        WriteEntryIndexes(batch, entry);
+        writeState = WriteBatch(batch);
+        entryCache.Erase(entry.vchFullObjectPath());
+        pubKeyCache.Erase(entry.DHTPublicKey);
     }
-    if (writeState)
+    if (writeState) {
+        NotifyDHTPubKeyAdded();
         AddDomainEntryIndex(entry, op);
+    }
 
     return writeState;
 }
@@ -111,16 +174,53 @@ void CDomainEntryDB::AddDomainEntryIndex(const CDomainEntry& entry, const int op
     }
 }
 
+static size_t CachedEntrySize(const CharString& vchKey, const CDomainEntryRef& pentry)
+{
+    return sizeof(CharString) + sizeof(CDomainEntryRef) + vchKey.size() + sizeof(CDomainEntry) + ::GetSerializeSize(*pentry, SER_DISK, CLIENT_VERSION);
+}
+
+bool CDomainEntryDB::ReadCachedEntry(CDomainEntryCache& cache, const std::string& strPrefix, const CharString& vchKey, CDomainEntry& entry)
+{
+    CDomainEntryRef pentry;
+    if (!cache.Get(vchKey, pentry)) {
+        // fill under the lock so a concurrent write can not be shadowed by the record it replaced
+        LOCK(cs_bdap_entry);
+        CDomainEntry dbEntry;
+        // unknown keys are not cached, random public keys would evict the hot entries and the
+        // database bloom filter already answers most of those lookups without a disk read
+        if (!CDBWrapper::Read(make_pair(strPrefix, vchKey), dbEntry))
+            return false;
+        pentry = std::make_shared<const CDomainEntry>(dbEntry);
+        cache.Put(vchKey, pentry, CachedEntrySize(vchKey, pentry));
+    }
+    entry = *pentry;
+    return true;
+}
+
 bool CDomainEntryDB::ReadDomainEntry(const std::vector<unsigned char>& vchObjectPath, CDomainEntry& entry) 
 {
-    LOCK(cs_bdap_entry);
-    return CDBWrapper::Read(make_pair(std::string("dc"), vchObjectPath), entry);
+    return ReadCachedEntry(entryCache, std::string("dc"), vchObjectPath, entry);
 }
 
 bool CDomainEntryDB::ReadDomainEntryPubKey(const std::vector<unsigned char>& vchPubKey, CDomainEntry& entry) 
 {
-    LOCK(cs_bdap_entry);
-    return CDBWrapper::Read(make_pair(std::string("pk"), vchPubKey), entry);
+    return ReadCachedEntry(pubKeyCache, std::string("pk"), vchPubKey, entry);
+}
+
+void CDomainEntryDB::SetEntryCacheSize(size_t nMaxBytes)
+{
+    entryCache.SetMaxBytes(nMaxBytes / 2);
+    pubKeyCache.SetMaxBytes(nMaxBytes / 2);
+}
+
+CLRUCacheStats CDomainEntryDB::GetEntryCacheStats() const
+{
+    return entryCache.GetStats();
+}
+
+CLRUCacheStats CDomainEntryDB::GetPubKeyCacheStats() const
+{
+    return pubKeyCache.GetStats();
 }
 
 bool CDomainEntryDB::EraseDomainEntry(const std::vector<unsigned char>& vchObjectPath) 
@@ -132,7 +232,12 @@ bool CDomainEntryDB::EraseDomainEntry(const std::vector<unsigned char>& vchObjec
         return false;
     }
 
-    return CDBWrapper::Erase(make_pair(std::string("dc"), vchObjectPath));
+    CDBBatch batch(*this);
+    batch.Erase(make_pair(std::string("dc"), vchObjectPath));
+    EraseEntryIndexes(batch, entry);
+    bool fErased = WriteBatch(batch);
+    entryCache.Erase(vchObjectPath);
+    return fErased;
 }
 
 bool CDomainEntryDB::EraseDomainEntryPubKey(const std::vector<unsigned char>& vchPubKey) 
@@ -142,54 +247,98 @@ bool CDomainEntryDB::EraseDomainEntryPubKey(const std::vector<unsigned char>& vc
     if (!ReadDomainEntryPubKey(vchPubKey, entry)) 
         return false;
 
-    return CDBWrapper::Erase(make_pair(std::string("pk"), vchPubKey));
+    bool fErased = CDBWrapper::Erase(make_pair(std::string("pk"), vchPubKey));
+    pubKeyCache.Erase(vchPubKey);
+    NotifyDHTPubKeyRemoved();
+    return fErased;
 }
 
 bool CDomainEntryDB::DomainEntryExists(const std::vector<unsigned char>& vchObjectPath)
 {
-    LOCK(cs_bdap_entry);
-    return CDBWrapper::Exists(make_pair(std::string("dc"), vchObjectPath));
+    CDomainEntry entry;
+    return ReadDomainEntry(vchObjectPath, entry);
 }
 
 bool CDomainEntryDB::DomainEntryExistsPubKey(const std::vector<unsigned char>& vchPubKey) 
 {
-    LOCK(cs_bdap_entry);
-    return CDBWrapper::Exists(make_pair(std::string("pk"), vchPubKey));
+    CDomainEntry entry;
+    return ReadDomainEntryPubKey(vchPubKey, entry);
 }
 
-bool CDomainEntryDB::RemoveExpired(int& entriesRemoved)
+// Calls fnVisit with every entry in the expiry index that expires after nPrevMedianTimePast and at or before nMedianTimePast
+template <typename Visit>
+static bool ForEachExpiringEntry(CDomainEntryDB& db, const uint64_t nPrevMedianTimePast, const uint64_t nMedianTimePast, Visit fnVisit)
 {
-    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
-    pcursor->SeekToFirst();
-    CDomainEntry entry;
-    std::pair<std::string, std::vector<unsigned char> > key;
+    if (nMedianTimePast <= nPrevMedianTimePast)
+        return true;
+
+    std::pair<std::string, CDomainEntryExpireKey> key;
+    boost::scoped_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(make_pair(DB_EXPIRE_INDEX, CDomainEntryExpireKey(nPrevMedianTimePast + 1, CharString())));
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
-        try {
-            if (pcursor->GetKey(key) && key.first == "dc") {
-                pcursor->GetValue(entry);
-                  if ((unsigned int)chainActive.Tip()->GetMedianTimePast() >= entry.nExpireTime)
-                {
-                    entriesRemoved++;
-                    EraseDomainEntry(key.second);
-                }
+        if (!pcursor->GetKey(key) || key.first != DB_EXPIRE_INDEX || key.second.nExpireTime > nMedianTimePast)
+            break;
+        CDomainEntry entry;
+        // the index key is written and erased with its entry, skip it if the entry moved on anyway
+        if (db.Read(make_pair(std::string("dc"), key.second.vchFullObjectPath), entry) && entry.nExpireTime == key.second.nExpireTime)
+            fnVisit(entry);
+        pcursor->Next();
+    }
+    return true;
+}
+
+bool CDomainEntryDB::ExpireEntries(const uint64_t nPrevMedianTimePast, const uint64_t nMedianTimePast, int& nExpired)
+{
+    LOCK(cs_bdap_entry);
+    CDBBatch batch(*this);
+    std::vector<CharString> vPubKeys;
+    try {
+        ForEachExpiringEntry(*this, nPrevMedianTimePast, nMedianTimePast, [&](const CDomainEntry& entry) {
+            CDomainEntry pubKeyEntry;
+            if (ReadDomainEntryPubKey(entry.DHTPublicKey, pubKeyEntry) && pubKeyEntry.vchFullObjectPath() == entry.vchFullObjectPath()) {
+                batch.Erase(make_pair(std::string("pk"), entry.DHTPublicKey));
+                vPubKeys.push_back(entry.DHTPublicKey);
+                nExpired++;
             }
-            else if (pcursor->GetKey(key) && key.first == "txid") {
-                std::vector<unsigned char> value;
-                CDomainEntry entry;
-                pcursor->GetValue(value);
-                if (GetDomainEntry(value, entry) && (unsigned int)chainActive.Tip()->GetMedianTimePast() >= entry.nExpireTime)
-                {
-                    entriesRemoved++;
-                    EraseDomainEntryPubKey(entry.DHTPublicKey);
-                }
+        });
+    } catch (std::exception& e) {
+        return error("%s() : deserialize error", __PRETTY_FUNCTION__);
+    }
+    if (vPubKeys.empty())
+        return true;
+
+    bool fWritten = WriteBatch(batch);
+    for (const CharString& vchPubKey : vPubKeys)
+        pubKeyCache.Erase(vchPubKey);
+    NotifyDHTPubKeyRemoved();
+    return fWritten;
+}
+
+bool CDomainEntryDB::RestoreExpiredEntries(const uint64_t nPrevMedianTimePast, const uint64_t nMedianTimePast, int& nRestored)
+{
+    LOCK(cs_bdap_entry);
+    CDBBatch batch(*this);
+    std::vector<CharString> vPubKeys;
+    try {
+        ForEachExpiringEntry(*this, nPrevMedianTimePast, nMedianTimePast, [&](const CDomainEntry& entry) {
+            if (!DomainEntryExistsPubKey(entry.DHTPublicKey)) {
+                batch.Write(make_pair(std::string("pk"), entry.DHTPublicKey), entry);
+                vPubKeys.push_back(entry.DHTPublicKey);
+                nRestored++;
             }
-            pcursor->Next();
-        } catch (std::exception &e) {
-            return error("%s() : deserialize error", __PRETTY_FUNCTION__);
-        }
+        });
+    } catch (std::exception& e) {
+        return error("%s() : deserialize error", __PRETTY_FUNCTION__);
     }
-    return true;
+    if (vPubKeys.empty())
+        return true;
+
+    bool fWritten = WriteBatch(batch);
+    for (const CharString& vchPubKey : vPubKeys)
+        pubKeyCache.Erase(vchPubKey);
+    NotifyDHTPubKeyAdded();
+    return fWritten;
 }
 
 void CDomainEntryDB::WriteDomainEntryIndexHistory(const CDomainEntry& entry, const int op) 
@@ -223,16 +372,23 @@ bool CDomainEntryDB::UpdateDomainEntry(const std::vector<unsigned char>& vchObje
         LogPrintf("CDomainEntryDB::%s -- EraseDomainEntry failed. vchObjectPath = %s\n", __func__, stringFromVch(vchObjectPath));
         return false;
     }
-    if (!EraseDomainEntryPubKey(entry.DHTPublicKey)) {
+    // the public key mapping is already gone when the entry expired
+    if (DomainEntryExistsPubKey(entry.DHTPublicKey) && !EraseDomainEntryPubKey(entry.DHTPublicKey)) {
         LogPrintf("CDomainEntryDB::%s -- EraseDomainEntryPubKey failed. vchObjectPath = %s\n", __func__, stringFromVch(entry.DHTPublicKey));
         return false;
     }
 
-    bool writeState = false;
-    writeState = Update(make_pair(std::string("dc"), entry.vchFullObjectPath()), entry) 
-                    && Update(make_pair(std::string("pk"), entry.DHTPublicKey), entry);
-    if (writeState)
+    CDBBatch batch(*this);
+    batch.Write(make_pair(std::string("dc"), entry.vchFullObjectPath()), entry);
+    batch.Write(make_pair(std::string("pk"), entry.DHTPublicKey), entry);
+    WriteEntryIndexes(batch, entry);
+    bool writeState = WriteBatch(batch);
+    entryCache.Erase(entry.vchFullObjectPath());
+    pubKeyCache.Erase(entry.DHTPublicKey);
+    if (writeState) {
+        NotifyDHTPubKeyAdded();
         AddDomainEntryIndex(entry, OP_BDAP_MODIFY);
+    }
 
     return writeState;
 }
@@ -273,56 +429,135 @@ bool CDomainEntryDB::CleanupLevelDB(int& nRemoved)
     return true;
 }
 
+// Walks index keys from start while fnInRange accepts them, handing each key to fnVisit until it returns false
+template <typename IndexKey, typename InRange, typename Visit>
+static void WalkIndex(CDBWrapper& db, const std::string& strIndex, const IndexKey& start, InRange fnInRange, Visit fnVisit)
+{
+    std::pair<std::string, IndexKey> key;
+    boost::scoped_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(make_pair(strIndex, start));
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        if (!pcursor->GetKey(key) || key.first != strIndex || !fnInRange(key.second))
+            break;
+        if (!fnVisit(key.second))
+            break;
+        pcursor->Next();
+    }
+}
+
 // Lists active entries by domain name with paging support
 bool CDomainEntryDB::ListDirectories(const std::vector<unsigned char>& vchObjectLocation, const unsigned int& nResultsPerPage, const unsigned int& nPage, UniValue& oDomainEntryList, const BDAP::ObjectType& accountType, const std::string searchString)
 {
-    // TODO: (bdap) implement paging
     // if vchObjectLocation is empty, list entries from all domains
-    int index = 0;
-    bool addEntry = true;
+    const unsigned int nObjectType = GetObjectTypeInt(accountType);
+    const bool fAnyType = (accountType == DEFAULT_ACCOUNT_TYPE);
+    const bool fSearch = searchString.size() > 0;
+    unsigned int nSkip = (nPage > 0 ? nPage - 1 : 0) * nResultsPerPage;
+    unsigned int nFound = 0;
+
+    // Called with candidate paths in index order. When fExact is set the index alone matches
+    // the filter, so entries on earlier pages are skipped without being read.
+    auto fnVisitPath = [&](const CharString& vchPath, const bool fExact) -> bool {
+        if (fExact && nSkip > 0) {
+            nSkip--;
+            return true;
+        }
+        // read around the entry cache so large listings do not evict the hot accounts
+        CDomainEntry entry;
+        if (!CDBWrapper::Read(make_pair(std::string("dc"), vchPath), entry))
+            return true;
+        if (!fAnyType && entry.nObjectType != nObjectType)
+            return true;
+        if (!vchObjectLocation.empty() && entry.vchObjectLocation() != vchObjectLocation)
+            return true;
+        if (fSearch && !MatchesSearch(entry, searchString))
+            return true;
+        if (nSkip > 0) {
+            nSkip--;
+            return true;
+        }
+        UniValue oDomainEntryEntry(UniValue::VOBJ);
+        BuildBDAPJson(entry, oDomainEntryEntry, false);
+        oDomainEntryList.push_back(oDomainEntryEntry);
+        nFound++;
+        return nResultsPerPage == 0 || nFound < nResultsPerPage;
+    };
+
+    try {
+        if (searchString.size() >= BDAP_SEARCH_GRAM_LENGTH) {
+            // every match contains the first gram of the search string
+            const CharString vchGram(searchString.begin(), searchString.begin() + BDAP_SEARCH_GRAM_LENGTH);
+            WalkIndex(*this, DB_SEARCH_INDEX, SearchIndexKey(vchGram, CharString()),
+                [&vchGram](const SearchIndexKey& key) { return key.first == vchGram; },
+                [&fnVisitPath](const SearchIndexKey& key) { return fnVisitPath(key.second, false); });
+        }
+        else if (!vchObjectLocation.empty()) {
+            WalkIndex(*this, DB_LOCATION_INDEX, LocationIndexKey(std::make_pair(vchObjectLocation, fAnyType ? 0 : nObjectType), CharString()),
+                [&](const LocationIndexKey& key) { return key.first.first == vchObjectLocation && (fAnyType || key.first.second == nObjectType); },
+                [&](const LocationIndexKey& key) { return fnVisitPath(key.second, !fSearch); });
+        }
+        else if (!fAnyType) {
+            WalkIndex(*this, DB_TYPE_INDEX, TypeIndexKey(nObjectType, CharString()),
+                [nObjectType](const TypeIndexKey& key) { return key.first == nObjectType; },
+                [&](const TypeIndexKey& key) { return fnVisitPath(key.second, !fSearch); });
+        }
+        else {
+            WalkIndex(*this, std::string("dc"), CharString(),
+                [](const CharString& key) { return true; },
+                [&](const CharString& key) { return fnVisitPath(key, !fSearch); });
+        }
+    }
+    catch (std::exception& e) {
+        return error("%s() : deserialize error", __PRETTY_FUNCTION__);
+    }
+    return true;
+}
+
+bool CDomainEntryDB::Upgrade(const uint64_t nMedianTimePast)
+{
+    int nIndexVersion = 0;
+    if (Read(DB_INDEX_VERSION, nIndexVersion) && nIndexVersion >= CURRENT_INDEX_VERSION)
+        return true;
+
+    LogPrintf("Building BDAP domain entry indexes...\n");
+    int64_t nStart = GetTimeMillis();
+    int64_t nIndexed = 0;
+    size_t nBatchSize = 1 << 24;
+    LOCK(cs_bdap_entry);
+    CDBBatch batch(*this);
     std::pair<std::string, CharString> key;
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-    pcursor->SeekToFirst();
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(make_pair(std::string("dc"), CharString()));
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
+        if (!pcursor->GetKey(key) || key.first != "dc")
+            break;
         CDomainEntry entry;
-        try {
-            if (pcursor->GetKey(key) && key.first == "dc") {
-                pcursor->GetValue(entry);
-                //filter by accountType, unless DEFAULT
-                if ((entry.nObjectType == GetObjectTypeInt(accountType)) ||  (accountType == DEFAULT_ACCOUNT_TYPE)) {
-                    if (vchObjectLocation.empty() || entry.vchObjectLocation() == vchObjectLocation)
-                    {
-                        addEntry = true; //always reset to true
-
-                        if (searchString.size() > 0) {
-                            //compare to ObjectID and Common Name
-                            std::string compareString(entry.ObjectID.begin(), entry.ObjectID.end());
-                            std::string compareCommonString(entry.CommonName.begin(), entry.CommonName.end());
-                            std::size_t found = compareString.find(searchString);
-                            std::size_t foundCommon = compareCommonString.find(searchString);
-
-                            if ((found==std::string::npos) && (foundCommon==std::string::npos))
-                                addEntry = false;
-                        }
-
-                        if (addEntry) 
-                        {
-                            UniValue oDomainEntryEntry(UniValue::VOBJ);
-                            BuildBDAPJson(entry, oDomainEntryEntry, false);
-                            oDomainEntryList.push_back(oDomainEntryEntry);
-                            index++;
-                        }
-                    }
-                } //if entry.nObjectType
-            }
-            pcursor->Next();
+        if (!pcursor->GetValue(entry))
+            return error("%s: cannot parse domain entry record", __func__);
+        WriteEntryIndexes(batch, entry);
+        nIndexed++;
+        if (batch.SizeEstimate() > nBatchSize) {
+            WriteBatch(batch);
+            batch.Clear();
         }
-        catch (std::exception& e) {
-            return error("%s() : deserialize error", __PRETTY_FUNCTION__);
-        } //try-catch
-
+        pcursor->Next();
     }
+    if (!WriteBatch(batch))
+        return false;
+
+    // blocks connected before the expiry index existed never expired their entries
+    int nExpired = 0;
+    if (nMedianTimePast > 0 && !ExpireEntries(0, nMedianTimePast, nExpired))
+        return false;
+
+    // written last so an interrupted upgrade runs again on the next start
+    batch.Clear();
+    batch.Write(DB_INDEX_VERSION, CURRENT_INDEX_VERSION);
+    if (!WriteBatch(batch, true))
+        return false;
+    LogPrintf("Indexed %d BDAP domain entries and expired %d in %dms\n", nIndexed, nExpired, GetTimeMillis() - nStart);
     return true;
 }
 
@@ -357,6 +592,35 @@ bool CheckDomainEntryDB()
     return true;
 }
 
+// Expires the entries whose expire time passed between the median time past of pindex's parent and pindex
+bool ExpireDomainEntries(const CBlockIndex* pindex)
+{
+    if (!pDomainEntryDB || !pindex->pprev)
+        return true;
+
+    int nExpired = 0;
+    if (!pDomainEntryDB->ExpireEntries(pindex->pprev->GetMedianTimePast(), pindex->GetMedianTimePast(), nExpired))
+        return false;
+
+    if (nExpired > 0)
+        LogPrint("bdap", "%s -- Expired %d entries at height %d\n", __func__, nExpired, pindex->nHeight);
+    return true;
+}
+
+bool RestoreExpiredDomainEntries(const CBlockIndex* pindex)
+{
+    if (!pDomainEntryDB || !pindex->pprev)
+        return true;
+
+    int nRestored = 0;
+    if (!pDomainEntryDB->RestoreExpiredEntries(pindex->pprev->GetMedianTimePast(), pindex->GetMedianTimePast(), nRestored))
+        return false;
+
+    if (nRestored > 0)
+        LogPrint("bdap", "%s -- Restored %d expired entries at height %d\n", __func__, nRestored, pindex->nHeight);
+    return true;
+}
+
 bool FlushLevelDB() 
 {
     {
@@ -501,9 +765,8 @@ static bool CheckDeleteDomainEntryTxInputs(const CDomainEntry& entry, const CScr
     }
     else
     {
-        CTransactionRef prevTx = MakeTransactionRef();
-        uint256 hashBlock;
-        if (!GetTransaction(prevDomainEntry.txHash, prevTx, Params().GetConsensus(), hashBlock, true)) {
+        CTransactionRef prevTx;
+        if (!GetPreviousTxRefById(prevDomainEntry.txHash, prevTx)) {
             errorMessage = "CheckDeleteDomainEntryTxInputs: - " + _("Cannot extract previous transaction from BDAP output; this delete operation failed!");
             return error(errorMessage.c_str());
         }
@@ -564,9 +827,8 @@ static bool CheckUpdateDomainEntryTxInputs(CDomainEntry& entry, const CScript& s
     }
     else
     {
-        CTransactionRef prevTx = MakeTransactionRef();
-        uint256 hashBlock;
-        if (!GetTransaction(prevDomainEntry.txHash, prevTx, Params().GetConsensus(), hashBlock, true)) {
+        CTransactionRef prevTx;
+        if (!GetPreviousTxRefById(prevDomainEntry.txHash, prevTx)) {
             errorMessage = "CheckUpdateDomainEntryTxInputs: - " + _("Cannot extract previous transaction from BDAP output; this update operation failed!");
             return error(errorMessage.c_str());
         }
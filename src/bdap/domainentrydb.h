@@ -7,17 +7,65 @@
 
 #include "bdap/domainentry.h"
 #include "dbwrapper.h"
+#include "dht/lrucache.h"
 #include "sync.h"
 
+#include <boost/functional/hash.hpp>
+
+#include <memory>
+
+class CBlockIndex;
 class CCoinsViewCache;
 
 static CCriticalSection cs_bdap_entry;
 
 const BDAP::ObjectType DEFAULT_ACCOUNT_TYPE = BDAP::ObjectType::BDAP_DEFAULT_TYPE;
+//! Length of the substrings indexed for ObjectID and CommonName searches
+static const size_t BDAP_SEARCH_GRAM_LENGTH = 3;
+/** Default for -bdapentrycache, in MiB */
+static const int64_t DEFAULT_BDAP_ENTRY_CACHE = 8;
+static const size_t BDAP_ENTRY_CACHE_SHARDS = 16;
+
+struct CCharStringHasher {
+    size_t operator()(const CharString& vch) const
+    {
+        return boost::hash_range(vch.begin(), vch.end());
+    }
+};
+
+//! Cached "dc" or "pk" record, only records that exist are cached
+typedef std::shared_ptr<const CDomainEntry> CDomainEntryRef;
+typedef CShardedLRUCache<CharString, CDomainEntryRef, CCharStringHasher> CDomainEntryCache;
+
+/** Expiry index key, the expire time is stored big endian so keys sort by it */
+struct CDomainEntryExpireKey {
+    uint64_t nExpireTime;
+    CharString vchFullObjectPath;
+
+    CDomainEntryExpireKey() : nExpireTime(0) {}
+    CDomainEntryExpireKey(uint64_t nExpireTimeIn, const CharString& vchFullObjectPathIn)
+        : nExpireTime(nExpireTimeIn), vchFullObjectPath(vchFullObjectPathIn) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata32be(s, (uint32_t)(nExpireTime >> 32));
+        ser_writedata32be(s, (uint32_t)nExpireTime);
+        ::Serialize(s, vchFullObjectPath);
+    }
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        nExpireTime = (uint64_t)ser_readdata32be(s) << 32;
+        nExpireTime |= ser_readdata32be(s);
+        ::Unserialize(s, vchFullObjectPath);
+    }
+};
 
 class CDomainEntryDB : public CDBWrapper {
 public:
-    CDomainEntryDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CDBWrapper(GetDataDir() / "blocks" / "bdap-entries", nCacheSize, fMemory, fWipe, obfuscate) {
+    CDomainEntryDB(size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate) : CDBWrapper(GetDataDir() / "blocks" / "bdap-entries", nCacheSize, fMemory, fWipe, obfuscate),
+        entryCache(BDAP_ENTRY_CACHE_SHARDS, (DEFAULT_BDAP_ENTRY_CACHE << 20) / 2), pubKeyCache(BDAP_ENTRY_CACHE_SHARDS, (DEFAULT_BDAP_ENTRY_CACHE << 20) / 2) {
     }
 
     // Add, Read, Modify, ModifyRDN, Delete, List, Search, Bind, and Compare
@@ -29,7 +77,10 @@ public:
     bool EraseDomainEntryPubKey(const std::vector<unsigned char>& vchPubKey);
     bool DomainEntryExists(const std::vector<unsigned char>& vchObjectPath);
     bool DomainEntryExistsPubKey(const std::vector<unsigned char>& vchPubKey);
-    bool RemoveExpired(int& entriesRemoved);
+    /** Drop the DHT public key mapping of entries that expired after nPrevMedianTimePast and at or before nMedianTimePast */
+    bool ExpireEntries(const uint64_t nPrevMedianTimePast, const uint64_t nMedianTimePast, int& nExpired);
+    /** Undo ExpireEntries for the same time range when its block is disconnected */
+    bool RestoreExpiredEntries(const uint64_t nPrevMedianTimePast, const uint64_t nMedianTimePast, int& nRestored);
     void WriteDomainEntryIndex(const CDomainEntry& entry, const int op);
     void WriteDomainEntryIndexHistory(const CDomainEntry& entry, const int op);
     bool UpdateDomainEntry(const std::vector<unsigned char>& vchObjectPath, const CDomainEntry& entry);
@@ -37,6 +88,23 @@ public:
     bool ListDirectories(const std::vector<unsigned char>& vchObjectLocation, const unsigned int& nResultsPerPage, const unsigned int& nPage, UniValue& oDomainEntryList, const BDAP::ObjectType& accountType = DEFAULT_ACCOUNT_TYPE, const std::string searchString = "");
     bool GetDomainEntryInfo(const std::vector<unsigned char>& vchFullObjectPath, UniValue& oDomainEntryInfo);
     bool GetDomainEntryInfo(const std::vector<unsigned char>& vchFullObjectPath, CDomainEntry& entry);
+    /** Build the location, type, search and expiry indexes for databases written before they existed,
+        then expire the entries whose expire time is not after nMedianTimePast, the chain tip's median time past */
+    bool Upgrade(const uint64_t nMedianTimePast);
+    /** Split nMaxBytes between the object path and DHT public key caches */
+    void SetEntryCacheSize(size_t nMaxBytes);
+    CLRUCacheStats GetEntryCacheStats() const;
+    CLRUCacheStats GetPubKeyCacheStats() const;
+
+private:
+    // Read-mostly caches in front of the "dc" and "pk" records. Misses are filled and
+    // writes invalidate while holding cs_bdap_entry, hits only take a shard mutex.
+    CDomainEntryCache entryCache;
+    CDomainEntryCache pubKeyCache;
+
+    bool ReadCachedEntry(CDomainEntryCache& cache, const std::string& strPrefix, const CharString& vchKey, CDomainEntry& entry);
+    void WriteEntryIndexes(CDBBatch& batch, const CDomainEntry& entry);
+    void EraseEntryIndexes(CDBBatch& batch, const CDomainEntry& entry);
 };
 
 bool GetDomainEntry(const std::vector<unsigned char>& vchObjectPath, CDomainEntry& entry);
@@ -48,6 +116,8 @@ bool UndoAddDomainEntry(const CDomainEntry& entry);
 bool UndoUpdateDomainEntry(const CDomainEntry& entry);
 bool UndoDeleteDomainEntry(const CDomainEntry& entry);
 bool CheckDomainEntryDB();
+bool ExpireDomainEntries(const CBlockIndex* pindex);
+bool RestoreExpiredDomainEntries(const CBlockIndex* pindex);
 bool FlushLevelDB();
 void CleanupLevelDB(int& nRemoved);
 bool CheckDomainEntryTx(const CTransactionRef& tx, const CScript& scriptOp, const int& op1, const int& op2, const std::vector<std::vector<unsigned char> >& vvchArgs, 
@@ -8,6 +8,7 @@
 #include "bdap/fees.h"
 #include "bdap/utils.h"
 #include "base58.h"
+#include "dht/limits.h"
 #include "utilmoneystr.h"
 #include "validation.h"
 #include "validationinterface.h"
@@ -33,6 +34,7 @@ bool CLinkDB::AddLinkIndex(const vchCharString& vvchOpParameters, const uint256&
         if (writeState && vvchOpParameters.size() > 1)
             writeState = Write(make_pair(std::string("pubkey"), stringFromVch(vvchOpParameters[1])), txid);
     }
+    NotifyDHTPubKeyAdded();
 
     return writeState;
 }
@@ -53,10 +55,10 @@ bool CLinkDB::EraseLinkIndex(const std::vector<unsigned char>& vchPubKey, const
     bool result = false;
     LOCK(cs_link);
     result = CDBWrapper::Erase(make_pair(std::string("pubkey"), vchPubKey));
-    if (!result)
-        return false;
-
-    return CDBWrapper::Erase(make_pair(std::string("pubkey"), vchSharedPubKey));
+    if (result)
+        result = CDBWrapper::Erase(make_pair(std::string("pubkey"), vchSharedPubKey));
+    NotifyDHTPubKeyRemoved();
+    return result;
 }
 
 bool CLinkDB::LinkExists(const std::vector<unsigned char>& vchPubKey)
@@ -172,10 +172,93 @@ bool CLinkManager::GetLinkPrivateKey(const std::vector<unsigned char>& vchSender
     return false;
 }
 
+static bool IsPendingRequest(const CLink& link)
+{
+    return link.nLinkState == 1 && link.fRequestFromMe;
+}
+
+static bool IsPendingAccept(const CLink& link)
+{
+    return link.nLinkState == 1 && (!link.fRequestFromMe || link.fAcceptFromMe);
+}
+
+void CLinkManager::IndexLink(const CLink& link)
+{
+    if (IsPendingRequest(link))
+        m_PendingRequests.insert(link.LinkID);
+    if (IsPendingAccept(link))
+        m_PendingAccepts.insert(link.LinkID);
+    if (link.nLinkState == 2)
+        m_Completed.insert(link.LinkID);
+
+    if (!link.SubjectID.IsNull())
+        m_LinksBySubjectID.emplace(link.SubjectID, link.LinkID);
+    m_LinksByFQDN.emplace(link.RequestorFullObjectPath, link.LinkID);
+    m_LinksByFQDN.emplace(link.RecipientFullObjectPath, link.LinkID);
+
+    if (!link.txHashRequest.IsNull())
+        m_LinkTxHashes.insert(link.txHashRequest);
+    if (!link.txHashAccept.IsNull())
+        m_LinkTxHashes.insert(link.txHashAccept);
+}
+
+void CLinkManager::UnindexLink(const CLink& link)
+{
+    m_PendingRequests.erase(link.LinkID);
+    m_PendingAccepts.erase(link.LinkID);
+    m_Completed.erase(link.LinkID);
+
+    m_LinksBySubjectID.erase(std::make_pair(link.SubjectID, link.LinkID));
+    m_LinksByFQDN.erase(std::make_pair(link.RequestorFullObjectPath, link.LinkID));
+    m_LinksByFQDN.erase(std::make_pair(link.RecipientFullObjectPath, link.LinkID));
+    // txids stay in m_LinkTxHashes, a link only ever gains request and accept data
+}
+
+// Stores a processed link, refreshes its indexes and saves it to the wallet
+void CLinkManager::UpdateLink(const CLink& link)
+{
+    std::map<uint256, CLink>::iterator it = m_Links.find(link.LinkID);
+    if (it != m_Links.end()) {
+        UnindexLink(it->second);
+        it->second = link;
+    }
+    else {
+        m_Links.emplace(link.LinkID, link);
+    }
+    IndexLink(link);
+
+    // records are plaintext, an encrypted wallet rebuilds its links from the link storage on unlock
+    if (pwalletMain && !pwalletMain->IsCrypted() && !pwalletMain->WriteLinkRecord(link))
+        LogPrintf("%s -- Failed to save link %s to the wallet\n", __func__, link.LinkID.ToString());
+}
+
+void CLinkManager::LoadLinkRecord(const CLink& link)
+{
+    std::map<uint256, CLink>::iterator it = m_Links.find(link.LinkID);
+    if (it != m_Links.end()) {
+        UnindexLink(it->second);
+        it->second = link;
+    }
+    else {
+        m_Links.emplace(link.LinkID, link);
+    }
+    IndexLink(link);
+}
+
+std::vector<uint256> CLinkManager::GetLinkIDs() const
+{
+    std::vector<uint256> vLinkIDs;
+    vLinkIDs.reserve(m_Links.size());
+    for (const std::pair<uint256, CLink>& link : m_Links)
+        vLinkIDs.push_back(link.first);
+    return vLinkIDs;
+}
+
 bool CLinkManager::FindLink(const uint256& id, CLink& link)
 {
-    if (m_Links.count(id) > 0) {
-        link = m_Links.at(id);
+    std::map<uint256, CLink>::const_iterator it = m_Links.find(id);
+    if (it != m_Links.end()) {
+        link = it->second;
         return true;
     }
     return false;
@@ -183,15 +266,12 @@ bool CLinkManager::FindLink(const uint256& id, CLink& link)
 
 bool CLinkManager::FindLinkBySubjectID(const uint256& subjectID, CLink& getLink)
 {
-    for (const std::pair<uint256, CLink>& link : m_Links)
-    {
-        if (link.second.SubjectID == subjectID) // pending request
-        {
-            getLink = link.second;
-            return true;
-        }
-    }
-    return false;
+    // the lowest link id for a subject, the one a full map scan finds first
+    std::set<std::pair<uint256, uint256>>::const_iterator it = m_LinksBySubjectID.lower_bound(std::make_pair(subjectID, uint256()));
+    if (it == m_LinksBySubjectID.end() || it->first != subjectID)
+        return false;
+
+    return FindLink(it->second, getLink);
 }
 
 void CLinkManager::ProcessQueue()
@@ -219,43 +299,38 @@ void CLinkManager::ProcessQueue()
 
 bool CLinkManager::ListMyPendingRequests(std::vector<CLink>& vchLinks)
 {
-    for (const std::pair<uint256, CLink>& link : m_Links)
-    {
-        if (link.second.nLinkState == 1 && link.second.fRequestFromMe) // pending request
-        {
-            vchLinks.push_back(link.second);
-        }
-    }
+    vchLinks.reserve(vchLinks.size() + m_PendingRequests.size());
+    for (const uint256& linkID : m_PendingRequests)
+        vchLinks.push_back(m_Links.at(linkID));
+
     return true;
 }
 
 bool CLinkManager::ListMyPendingAccepts(std::vector<CLink>& vchLinks)
 {
-    for (const std::pair<uint256, CLink>& link : m_Links)
-    {
-        //LogPrintf("%s -- link:\n%s\n", __func__, link.second.ToString());
-        if (link.second.nLinkState == 1 && (!link.second.fRequestFromMe || (link.second.fRequestFromMe && link.second.fAcceptFromMe))) // pending accept
-        {
-            vchLinks.push_back(link.second);
-        }
-    }
+    vchLinks.reserve(vchLinks.size() + m_PendingAccepts.size());
+    for (const uint256& linkID : m_PendingAccepts)
+        vchLinks.push_back(m_Links.at(linkID));
+
     return true;
 }
 
 bool CLinkManager::ListMyCompleted(std::vector<CLink>& vchLinks)
 {
-    for (const std::pair<uint256, CLink>& link : m_Links)
+    for (const uint256& linkID : m_Completed)
     {
-        if (link.second.nLinkState == 2 && !link.second.txHashRequest.IsNull()) // completed link
-        {
-            vchLinks.push_back(link.second);
-        }
+        const CLink& link = m_Links.at(linkID);
+        if (!link.txHashRequest.IsNull()) // completed link
+            vchLinks.push_back(link);
     }
     return true;
 }
 
 bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQueueOnly)
 {
+    // already merged into a link restored from the wallet, skip decrypting it again
+    if (m_LinkTxHashes.count(storage.txHash) > 0)
+        return true;
 
     if (!pwalletMain) {
         linkQueue.push(storage);
@@ -320,7 +395,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                         //LogPrintf("%s -- link request = %s\n", __func__, record.ToString());
                     }
                     LogPrint("bdap", "%s -- Clear text link request added to map id = %s\n", __func__, linkID.ToString());
-                    m_Links[linkID] = record;
+                    UpdateLink(record);
 
                 }
                 else
@@ -377,7 +452,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                         //LogPrintf("%s -- link accept = %s\n", __func__, record.ToString());
                     }
                     LogPrint("bdap", "%s -- Clear text accept added to map id = %s, %s\n", __func__, linkID.ToString(), record.ToString());
-                    m_Links[linkID] = record;
+                    UpdateLink(record);
                 }
                 else
                     LogPrintf("%s -- Warning! Link accept found with an invalid signature proof! Link requestor = %s, recipient = %s, pubkey = %s\n", __func__, link.RequestorFQDN(), link.RecipientFQDN(), stringFromVch(storage.vchLinkPubKey));
@@ -464,7 +539,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                             //LogPrintf("%s -- link request = %s\n", __func__, record.ToString());
                         }
                         LogPrint("bdap", "%s -- Encrypted link request from me added to map id = %s\n%s\n", __func__, linkID.ToString(), record.ToString());
-                        m_Links[linkID] = record;
+                        UpdateLink(record);
                     }
                     else {
                         LogPrintf("%s -- Link request GetBDAPData failed.\n", __func__);
@@ -549,7 +624,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                             //LogPrintf("%s -- link request = %s\n", __func__, record.ToString());
                         }
                         LogPrint("bdap", "%s -- Encrypted link request for me added to map id = %s\n%s\n", __func__, linkID.ToString(), record.ToString());
-                        m_Links[linkID] = record;
+                        UpdateLink(record);
                     }
                     else {
                         LogPrintf("%s -- Link request GetBDAPData failed.\n", __func__);
@@ -626,7 +701,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                             //LogPrintf("%s -- accept request = %s\n", __func__, record.ToString());
                         }
                         LogPrint("bdap", "%s -- Encrypted link accept from me added to map id = %s\n%s\n", __func__, linkID.ToString(), record.ToString());
-                        m_Links[linkID] = record;
+                        UpdateLink(record);
                     }
                     else {
                         LogPrintf("%s -- Link accept GetBDAPData failed.\n", __func__);
@@ -704,7 +779,7 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
                             //LogPrintf("%s -- accept request = %s\n", __func__, record.ToString());
                         }
                         LogPrint("bdap", "%s -- Encrypted link accept for me added to map id = %s\n%s\n", __func__, linkID.ToString(), record.ToString());
-                        m_Links[linkID] = record;
+                        UpdateLink(record);
                     }
                     else {
                         LogPrintf("%s -- Link accept GetBDAPData failed.\n", __func__);
@@ -732,18 +807,20 @@ bool CLinkManager::ProcessLink(const CLinkStorage& storage, const bool fStoreInQ
 std::vector<CLinkInfo> CLinkManager::GetCompletedLinkInfo(const std::vector<unsigned char>& vchFullObjectPath)
 {
     std::vector<CLinkInfo> vchLinkInfo;
-    for(const std::pair<uint256, CLink>& link : m_Links)
+    std::set<std::pair<std::vector<unsigned char>, uint256>>::const_iterator it = m_LinksByFQDN.lower_bound(std::make_pair(vchFullObjectPath, uint256()));
+    for (; it != m_LinksByFQDN.end() && it->first == vchFullObjectPath; ++it)
     {
-        if (link.second.nLinkState == 2) // completed link
+        const CLink& link = m_Links.at(it->second);
+        if (link.nLinkState == 2) // completed link
         {
-            if (link.second.RequestorFullObjectPath == vchFullObjectPath)
+            if (link.RequestorFullObjectPath == vchFullObjectPath)
             {
-                CLinkInfo linkInfo(link.second.RecipientFullObjectPath, link.second.RecipientPubKey, link.second.RequestorPubKey);
+                CLinkInfo linkInfo(link.RecipientFullObjectPath, link.RecipientPubKey, link.RequestorPubKey);
                 vchLinkInfo.push_back(linkInfo);
             }
-            else if (link.second.RecipientFullObjectPath == vchFullObjectPath)
+            else if (link.RecipientFullObjectPath == vchFullObjectPath)
             {
-                CLinkInfo linkInfo(link.second.RequestorFullObjectPath, link.second.RequestorPubKey, link.second.RecipientPubKey);
+                CLinkInfo linkInfo(link.RequestorFullObjectPath, link.RequestorPubKey, link.RecipientPubKey);
                 vchLinkInfo.push_back(linkInfo);
             }
         }
@@ -11,6 +11,7 @@
 #include <array>
 #include <map>
 #include <queue>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -63,6 +64,35 @@ public:
         SetNull();
     }
 
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(this->nVersion);
+        READWRITE(LinkID);
+        READWRITE(fRequestFromMe);
+        READWRITE(fAcceptFromMe);
+        READWRITE(nLinkState);
+        READWRITE(RequestorFullObjectPath);
+        READWRITE(RecipientFullObjectPath);
+        READWRITE(RequestorPubKey);
+        READWRITE(RecipientPubKey);
+        READWRITE(SharedRequestPubKey);
+        READWRITE(SharedAcceptPubKey);
+        READWRITE(LinkMessage);
+        READWRITE(RequestorWalletAddress);
+        READWRITE(RecipientWalletAddress);
+        READWRITE(VARINT(nHeightRequest));
+        READWRITE(VARINT(nExpireTimeRequest));
+        READWRITE(txHashRequest);
+        READWRITE(VARINT(nHeightAccept));
+        READWRITE(VARINT(nExpireTimeAccept));
+        READWRITE(txHashAccept);
+        READWRITE(SubjectID);
+        READWRITE(vchSecretPubKeyBytes);
+    }
+
     inline void SetNull()
     {
         nVersion = CLink::CURRENT_VERSION;
@@ -139,6 +169,13 @@ private:
     std::queue<CLinkStorage> linkQueue;
     std::map<uint256, CLink> m_Links;
     std::map<uint256, std::vector<unsigned char>> m_LinkMessageInfo;
+    // Secondary indexes over m_Links, kept in step by UpdateLink
+    std::set<uint256> m_PendingRequests; // pending links requested by me
+    std::set<uint256> m_PendingAccepts; // pending links waiting on an accept from me
+    std::set<uint256> m_Completed; // completed links
+    std::set<std::pair<uint256, uint256>> m_LinksBySubjectID; // (SubjectID, LinkID)
+    std::set<std::pair<std::vector<unsigned char>, uint256>> m_LinksByFQDN; // both parties' object paths
+    std::set<uint256> m_LinkTxHashes; // request and accept txids already merged into m_Links
 
 public:
     CLinkManager() {
@@ -150,13 +187,22 @@ public:
         std::queue<CLinkStorage> emptyQueue;
         linkQueue = emptyQueue;
         m_Links.clear();
+        m_PendingRequests.clear();
+        m_PendingAccepts.clear();
+        m_Completed.clear();
+        m_LinksBySubjectID.clear();
+        m_LinksByFQDN.clear();
+        m_LinkTxHashes.clear();
     }
 
     std::size_t QueueSize() const { return linkQueue.size(); }
     std::size_t LinkCount() const { return m_Links.size(); }
+    std::vector<uint256> GetLinkIDs() const;
 
     bool ProcessLink(const CLinkStorage& storage, const bool fStoreInQueueOnly = false);
     void ProcessQueue();
+    /** Restore a link saved in the wallet, its link storage records are then skipped */
+    void LoadLinkRecord(const CLink& link);
 
     bool FindLink(const uint256& id, CLink& link);
     bool FindLinkBySubjectID(const uint256& subjectID, CLink& getLink);
@@ -170,6 +216,9 @@ public:
     bool GetAllMessagesByType(const std::vector<unsigned char> vchMessageType);
 
 private:
+    void IndexLink(const CLink& link);
+    void UnindexLink(const CLink& link);
+    void UpdateLink(const CLink& link);
     bool IsLinkFromMe(const std::vector<unsigned char>& vchLinkPubKey);
     bool IsLinkForMe(const std::vector<unsigned char>& vchLinkPubKey, const std::vector<unsigned char>& vchSharedPubKey);
     bool GetLinkPrivateKey(const std::vector<unsigned char>& vchSenderPubKey, const std::vector<unsigned char>& vchSharedPubKey, std::array<char, 32>& sharedSeed, std::string& strErrorMessage);
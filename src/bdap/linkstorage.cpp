@@ -36,6 +36,22 @@ void LoadLinkMessageInfo(const uint256& subjectID, const std::vector<unsigned ch
     pLinkManager->LoadLinkMessageInfo(subjectID, vchPubKey);
 }
 
+void LoadLinkRecord(const CLink& link)
+{
+    if (!pLinkManager)
+        throw std::runtime_error("pLinkManager is null.\n");
+
+    pLinkManager->LoadLinkRecord(link);
+}
+
+std::vector<uint256> GetLinkRecordIDs()
+{
+    if (!pLinkManager)
+        return std::vector<uint256>();
+
+    return pLinkManager->GetLinkIDs();
+}
+
 void CLinkStorage::Serialize(std::vector<unsigned char>& vchData) 
 {
     CDataStream dsLinkStorage(SER_NETWORK, PROTOCOL_VERSION);
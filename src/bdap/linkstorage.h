@@ -11,6 +11,8 @@
 #include <array>
 #include <vector>
 
+class CLink;
+
 namespace BDAP {
 
     enum LinkType : std::uint8_t
@@ -139,5 +141,7 @@ public:
 void ProcessLink(const CLinkStorage& storage, const bool fStoreInQueueOnly = false);
 void ProcessLinkQueue();
 void LoadLinkMessageInfo(const uint256& subjectID, const std::vector<unsigned char>& vchPubKey);
+void LoadLinkRecord(const CLink& link);
+std::vector<uint256> GetLinkRecordIDs();
 
 #endif // DYNAMIC_BDAP_LINKSTORAGE_H
\ No newline at end of file
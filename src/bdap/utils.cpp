@@ -9,6 +9,7 @@
 #include "core_io.h"
 #include "policy/policy.h"
 #include "serialize.h"
+#include "txdb.h"
 #include "uint256.h"
 #include "validation.h"
 #include "wallet/wallet.h"
@@ -112,8 +113,33 @@ bool IsBDAPDataOutput(const CTxOut& out) {
    return false;
 }
 
+bool ReadBDAPTransaction(const uint256& hash, CTransactionRef& txOut)
+{
+    CDiskTxPos postx;
+    if (!pblocktree || !pblocktree->ReadBDAPTxIndex(hash, postx))
+        return false;
+
+    CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
+    if (file.IsNull())
+        return error("%s: OpenBlockFile failed", __func__);
+    try {
+        // the offset is relative to the end of the block header
+        file.ignore(::GetSerializeSize(CBlockHeader(), SER_DISK, CLIENT_VERSION));
+        fseek(file.Get(), postx.nTxOffset, SEEK_CUR);
+        file >> txOut;
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+    }
+    if (txOut->GetHash() != hash)
+        return error("%s: txid mismatch", __func__);
+    return true;
+}
+
 bool GetBDAPTransaction(int nHeight, const uint256& hash, CTransactionRef &txOut, const Consensus::Params& consensusParams)
 {
+    if (ReadBDAPTransaction(hash, txOut))
+        return true;
+
     if(nHeight < 0 || nHeight > chainActive.Height())
         return false;
 
@@ -623,6 +649,9 @@ int GetLinkVersionFromData(const std::vector<unsigned char>& vchData)
 
 bool GetPreviousTxRefById(const uint256& prevTxId, CTransactionRef& prevTx)
 {
+    if (ReadBDAPTransaction(prevTxId, prevTx))
+        return true;
+
     prevTx = MakeTransactionRef();
     uint256 hashBlock;
     if (!GetTransaction(prevTxId, prevTx, Params().GetConsensus(), hashBlock, true))
@@ -54,6 +54,8 @@ bool GetBDAPCreditScript(const CTransactionRef& ptx, CScript& scriptBDAPScredit)
 bool IsBDAPOperationOutput(const CTxOut& out);
 int GetBDAPOperationOutIndex(const CTransactionRef& tx);
 int GetBDAPOperationOutIndex(int nHeight, const uint256& txHash);
+/** Read a BDAP transaction from the block files through the BDAP transaction index */
+bool ReadBDAPTransaction(const uint256& hash, CTransactionRef& txOut);
 bool GetBDAPTransaction(int nHeight, const uint256& hash, CTransactionRef &txOut, const Consensus::Params& consensusParams);
 CDynamicAddress GetScriptAddress(const CScript& pubScript);
 int GetBDAPOpCodeFromOutput(const CTxOut& out);
@@ -0,0 +1,53 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "crypto/argon2d/opt.h"
+#include "hash.h"
+#include "primitives/block.h"
+
+#include <cassert>
+
+/* Hashes a block header with the given fill_segment kernel. Kernels that are
+ * not built in or not supported by this CPU are skipped.
+ */
+static void Argon2dHeader(benchmark::State& state, const char* impl)
+{
+    if (argon2d_select_impl(impl) != ARGON2_OK)
+        return;
+
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.nBits = 0x1e0ffff0;
+    while (state.KeepRunning()) {
+        header.ComputeHash();
+        header.nNonce++;
+    }
+    argon2d_autodetect();
+}
+
+static void Argon2dHeaderSSE2(benchmark::State& state) { Argon2dHeader(state, "sse2"); }
+static void Argon2dHeaderAVX2(benchmark::State& state) { Argon2dHeader(state, "avx2"); }
+static void Argon2dHeaderAVX512F(benchmark::State& state) { Argon2dHeader(state, "avx512f"); }
+
+BENCHMARK(Argon2dHeaderSSE2);
+BENCHMARK(Argon2dHeaderAVX2);
+BENCHMARK(Argon2dHeaderAVX512F);
+
+/* Hashes a block header 16 nonces at a time, as the CPU miner does */
+static void Argon2dHeaderNonceBatch(benchmark::State& state)
+{
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.nBits = 0x1e0ffff0;
+    uint256 hashes[16];
+    while (state.KeepRunning()) {
+        bool fHashed = header.ComputeHashes(16, hashes);
+        assert(fHashed);
+        header.nNonce += 16;
+    }
+}
+
+BENCHMARK(Argon2dHeaderNonceBatch);
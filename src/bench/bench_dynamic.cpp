@@ -4,6 +4,7 @@
 
 #include "bench.h"
 
+#include "crypto/argon2d/opt.h"
 #include "key.h"
 #include "random.h"
 #include "validation.h"
@@ -14,6 +15,7 @@ main(int argc, char** argv)
 {
     RandomInit();
     ECC_Start();
+    argon2d_autodetect();
     SetupEnvironment();
     fPrintToDebugLog = false; // don't want to write to debug.log file
 
@@ -0,0 +1,55 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "dht/ed25519.h"
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+#define BATCH_SIZE 64
+
+// A burst of mutable item puts, each signed by its own key with one repeat per pair
+static std::vector<CEd25519SignatureCheck> MakeSignatureChecks()
+{
+    std::vector<CEd25519SignatureCheck> vChecks;
+    for (int i = 0; i < BATCH_SIZE / 2; i++) {
+        CKeyEd25519 key;
+        std::string strValue = "12:link-request";
+        std::string strSalt = "pshare-filter";
+        std::vector<unsigned char> vchMsg = MutableItemSignedBytes(std::vector<unsigned char>(strValue.begin(), strValue.end()), i,
+                                                                   std::vector<unsigned char>(strSalt.begin(), strSalt.end()));
+        std::vector<unsigned char> vchSig;
+        key.Sign(vchMsg, vchSig);
+        vChecks.emplace_back(key.GetPubKeyBytes(), vchSig, vchMsg);
+        vChecks.emplace_back(key.GetPubKeyBytes(), vchSig, vchMsg);
+    }
+    return vChecks;
+}
+
+static void Ed25519VerifyEach(benchmark::State& state)
+{
+    std::vector<CEd25519SignatureCheck> vChecks = MakeSignatureChecks();
+    while (state.KeepRunning()) {
+        bool fValid = true;
+        for (const CEd25519SignatureCheck& check : vChecks)
+            fValid &= Ed25519Verify(check);
+        assert(fValid);
+    }
+}
+
+static void Ed25519VerifyBatched(benchmark::State& state)
+{
+    std::vector<CEd25519SignatureCheck> vChecks = MakeSignatureChecks();
+    std::vector<bool> vValid;
+    while (state.KeepRunning()) {
+        bool fValid = Ed25519VerifyBatch(vChecks, vValid);
+        assert(fValid);
+    }
+}
+
+BENCHMARK(Ed25519VerifyEach);
+BENCHMARK(Ed25519VerifyBatched);
@@ -0,0 +1,178 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "crypto/argon2d/arena.h"
+
+#if defined(HAVE_CONFIG_H)
+#include "config/dynamic-config.h"
+#endif
+
+#ifdef WIN32
+#ifdef _WIN32_WINNT
+#undef _WIN32_WINNT
+#endif
+#define _WIN32_WINNT 0x0501
+#define WIN32_LEAN_AND_MEAN 1
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h> // for mmap
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h> // for SYS_mbind
+#include <unistd.h>
+#endif
+
+#include <atomic>
+
+#include <stdlib.h>
+
+namespace
+{
+/** Huge page size assumed when rounding hugetlb mappings (x86-64 and aarch64 default). */
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+std::atomic<uint64_t> nArenaMaps(0);
+std::atomic<uint64_t> nArenaReuses(0);
+std::atomic<uint64_t> nArenaHugePages(0);
+std::atomic<uint64_t> nArenaFallbacks(0);
+
+/** Prefers pages of a fresh, untouched mapping from one NUMA node. */
+void BindMemory(void* addr, size_t size, int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node < 0 || node >= (int)(8 * sizeof(unsigned long)))
+        return;
+    const int MPOL_PREFERRED = 1; // from <numaif.h>, falls back to other nodes when this one is full
+    unsigned long nodemask = 1UL << node;
+    syscall(SYS_mbind, addr, size, MPOL_PREFERRED, &nodemask, 8 * sizeof(nodemask), 0);
+#endif
+}
+
+void* MapMemory(size_t& size, int node)
+{
+#ifdef WIN32
+    return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+#ifdef MAP_HUGETLB
+    // Explicit huge pages only exist if the administrator reserved some
+    // (vm.nr_hugepages), so fall through to a regular mapping on failure.
+    size_t huge_size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    void* huge = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (huge != MAP_FAILED) {
+        size = huge_size;
+        nArenaHugePages.fetch_add(1, std::memory_order_relaxed);
+        BindMemory(huge, size, node);
+        return huge;
+    }
+#endif
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED)
+        return nullptr;
+#ifdef MADV_HUGEPAGE
+    // Ask for transparent huge pages; harmless if THP is disabled.
+    madvise(addr, size, MADV_HUGEPAGE);
+#endif
+    BindMemory(addr, size, node);
+    return addr;
+#endif
+}
+
+void UnmapMemory(void* addr, size_t size)
+{
+#ifdef WIN32
+    VirtualFree(addr, 0, MEM_RELEASE);
+#else
+    munmap(addr, size);
+#endif
+}
+
+class ThreadArena
+{
+public:
+    uint8_t* base;
+    size_t size;
+    bool fInUse;
+    int node;
+
+    ThreadArena() : base(nullptr), size(0), fInUse(false), node(-1) {}
+    ~ThreadArena() { Release(); }
+
+    void Release()
+    {
+        if (base)
+            UnmapMemory(base, size);
+        base = nullptr;
+        size = 0;
+    }
+};
+
+thread_local ThreadArena threadArena;
+} // namespace
+
+int Argon2dArenaAllocate(uint8_t** memory, size_t bytes_to_allocate)
+{
+    ThreadArena& arena = threadArena;
+    if (arena.fInUse) {
+        // Argon2d does not nest on one thread, but never hand out the same
+        // memory twice if a caller ever does.
+        nArenaFallbacks.fetch_add(1, std::memory_order_relaxed);
+        *memory = static_cast<uint8_t*>(malloc(bytes_to_allocate));
+        return *memory ? 0 : -1;
+    }
+    if (arena.size < bytes_to_allocate) {
+        arena.Release();
+        size_t size = bytes_to_allocate;
+        void* addr = MapMemory(size, arena.node);
+        if (!addr) {
+            *memory = nullptr;
+            return -1;
+        }
+        arena.base = static_cast<uint8_t*>(addr);
+        arena.size = size;
+        nArenaMaps.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        nArenaReuses.fetch_add(1, std::memory_order_relaxed);
+    }
+    arena.fInUse = true;
+    *memory = arena.base;
+    return 0;
+}
+
+void Argon2dArenaFree(uint8_t* memory, size_t bytes_to_allocate)
+{
+    ThreadArena& arena = threadArena;
+    if (memory && memory == arena.base) {
+        arena.fInUse = false;
+        return;
+    }
+    free(memory);
+}
+
+void Argon2dArenaRelease()
+{
+    ThreadArena& arena = threadArena;
+    if (!arena.fInUse)
+        arena.Release();
+}
+
+void Argon2dArenaBindNode(int node)
+{
+    ThreadArena& arena = threadArena;
+    arena.node = node;
+    Argon2dArenaRelease();
+}
+
+Argon2dArenaStats GetArgon2dArenaStats()
+{
+    Argon2dArenaStats stats;
+    stats.nMaps = nArenaMaps.load(std::memory_order_relaxed);
+    stats.nReuses = nArenaReuses.load(std::memory_order_relaxed);
+    stats.nHugePages = nArenaHugePages.load(std::memory_order_relaxed);
+    stats.nFallbacks = nArenaFallbacks.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DYNAMIC_CRYPTO_ARGON2D_ARENA_H
+#define DYNAMIC_CRYPTO_ARGON2D_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Per-thread Argon2d working memory.
+ *
+ * Every thread that hashes keeps one mapping that is reused from hash to hash,
+ * so the miner and validation no longer pay for page faults and kernel zeroing
+ * of a fresh buffer on every call. Where the platform allows it the mapping is
+ * backed by huge pages. The mapping is released when the thread exits.
+ *
+ * Both functions match the argon2_context allocate_cbk/free_cbk signatures.
+ */
+int Argon2dArenaAllocate(uint8_t** memory, size_t bytes_to_allocate);
+void Argon2dArenaFree(uint8_t* memory, size_t bytes_to_allocate);
+
+/** Unmaps the calling thread's arena; the next hash maps a new one. */
+void Argon2dArenaRelease();
+
+/**
+ * Places the calling thread's future mappings on the given NUMA node (-1 for
+ * the default policy) and drops its current one. Meant for threads pinned to
+ * a CPU, so Argon2d memory stays local to the socket doing the hashing.
+ */
+void Argon2dArenaBindNode(int node);
+
+struct Argon2dArenaStats {
+    uint64_t nMaps;      //!< mappings created (first use or growth)
+    uint64_t nReuses;    //!< hashes served from an existing mapping
+    uint64_t nHugePages; //!< mappings backed by huge pages
+    uint64_t nFallbacks; //!< nested allocations served by malloc
+};
+
+Argon2dArenaStats GetArgon2dArenaStats();
+
+#endif // DYNAMIC_CRYPTO_ARGON2D_ARENA_H
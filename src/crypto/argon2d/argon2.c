@@ -36,11 +36,11 @@ const char *argon2_type2string(argon2_type type, int uppercase) {
     return NULL;
 }
 
-int argon2_ctx(argon2_context *context, argon2_type type) {
+static int setup_instance(argon2_instance_t *instance,
+                          const argon2_context *context, argon2_type type) {
     /* 1. Validate all inputs */
     int result = validate_inputs(context);
     uint32_t memory_blocks, segment_length;
-    argon2_instance_t instance;
 
     if (ARGON2_OK != result) {
         return result;
@@ -62,17 +62,28 @@ int argon2_ctx(argon2_context *context, argon2_type type) {
     /* Ensure that all segments have equal length */
     memory_blocks = segment_length * (context->lanes * ARGON2_SYNC_POINTS);
 
-    instance.memory = NULL;
-    instance.passes = context->t_cost;
-    instance.memory_blocks = memory_blocks;
-    instance.segment_length = segment_length;
-    instance.lane_length = segment_length * ARGON2_SYNC_POINTS;
-    instance.lanes = context->lanes;
-    instance.threads = context->threads;
-    instance.type = type;
-
-    if (instance.threads > instance.lanes) {
-        instance.threads = instance.lanes;
+    instance->memory = NULL;
+    instance->passes = context->t_cost;
+    instance->memory_blocks = memory_blocks;
+    instance->segment_length = segment_length;
+    instance->lane_length = segment_length * ARGON2_SYNC_POINTS;
+    instance->lanes = context->lanes;
+    instance->threads = context->threads;
+    instance->type = type;
+
+    if (instance->threads > instance->lanes) {
+        instance->threads = instance->lanes;
+    }
+
+    return ARGON2_OK;
+}
+
+int argon2_ctx(argon2_context *context, argon2_type type) {
+    argon2_instance_t instance;
+    int result = setup_instance(&instance, context, type);
+
+    if (ARGON2_OK != result) {
+        return result;
     }
 
     /* 3. Initialization: Hashing inputs, allocating memory, filling first
@@ -96,6 +107,28 @@ int argon2_ctx(argon2_context *context, argon2_type type) {
     return ARGON2_OK;
 }
 
+int argon2d_ctx_nonces(argon2_context *context, uint32_t nonce_offset,
+                       uint32_t count) {
+    argon2_instance_t instance;
+    int result = setup_instance(&instance, context, Argon2_d);
+
+    if (ARGON2_OK != result) {
+        return result;
+    }
+
+    /* The nonce must be inside the password, which must survive the batch */
+    if (context->pwd == NULL || (uint64_t)nonce_offset + 4 > context->pwdlen ||
+        (context->flags & ARGON2_FLAG_CLEAR_PASSWORD)) {
+        return ARGON2_INCORRECT_PARAMETER;
+    }
+
+    if (count == 0) {
+        return ARGON2_OK;
+    }
+
+    return hash_nonces(&instance, context, nonce_offset, count);
+}
+
 int argon2_hash(const uint32_t t_cost, const uint32_t m_cost,
                 const uint32_t parallelism, const void *pwd,
                 const size_t pwdlen, const void *salt, const size_t saltlen,
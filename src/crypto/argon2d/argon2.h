@@ -279,6 +279,19 @@ ARGON2_PUBLIC int argon2_verify(const char* encoded, const void* pwd, const size
  */
 ARGON2_PUBLIC int argon2d_ctx(argon2_context* context);
 
+/**
+ * Argon2d over a batch of nonces, for miners: the 32-bit little endian nonce
+ * at @nonce_offset in the password (and in the salt when it points to the
+ * same buffer) takes count consecutive values starting from the one in the
+ * buffer. Inputs are validated and memory is allocated once per batch.
+ *****
+ * @param  context  Pointer to current Argon2 context, out must hold count * outlen bytes
+ * @param  nonce_offset  Offset of the nonce in the password
+ * @param  count  Number of nonces to hash
+ * @return  Zero if successful, a non zero error code otherwise
+ */
+ARGON2_PUBLIC int argon2d_ctx_nonces(argon2_context* context, uint32_t nonce_offset, uint32_t count);
+
 /**
  * Verify if a given password is correct for Argon2d hashing
  * @param  context  Pointer to current Argon2 context
@@ -137,30 +137,34 @@ void clear_internal_memory(void *v, size_t n) {
   }
 }
 
-void finalize(const argon2_context *context, argon2_instance_t *instance) {
-    if (context != NULL && instance != NULL) {
-        block blockhash;
-        uint32_t l;
+static void finalize_output(const argon2_instance_t *instance, uint8_t *out,
+                            uint32_t outlen) {
+    block blockhash;
+    uint32_t l;
 
-        copy_block(&blockhash, instance->memory + instance->lane_length - 1);
+    copy_block(&blockhash, instance->memory + instance->lane_length - 1);
 
-        /* XOR the last blocks */
-        for (l = 1; l < instance->lanes; ++l) {
-            uint32_t last_block_in_lane =
-                l * instance->lane_length + (instance->lane_length - 1);
-            xor_block(&blockhash, instance->memory + last_block_in_lane);
-        }
+    /* XOR the last blocks */
+    for (l = 1; l < instance->lanes; ++l) {
+        uint32_t last_block_in_lane =
+            l * instance->lane_length + (instance->lane_length - 1);
+        xor_block(&blockhash, instance->memory + last_block_in_lane);
+    }
 
-        /* Hash the result */
-        {
-            uint8_t blockhash_bytes[ARGON2_BLOCK_SIZE];
-            store_block(blockhash_bytes, &blockhash);
-            blake2b_long(context->out, context->outlen, blockhash_bytes,
-                         ARGON2_BLOCK_SIZE);
-            /* clear blockhash and blockhash_bytes */
-            clear_internal_memory(blockhash.v, ARGON2_BLOCK_SIZE);
-            clear_internal_memory(blockhash_bytes, ARGON2_BLOCK_SIZE);
-        }
+    /* Hash the result */
+    {
+        uint8_t blockhash_bytes[ARGON2_BLOCK_SIZE];
+        store_block(blockhash_bytes, &blockhash);
+        blake2b_long(out, outlen, blockhash_bytes, ARGON2_BLOCK_SIZE);
+        /* clear blockhash and blockhash_bytes */
+        clear_internal_memory(blockhash.v, ARGON2_BLOCK_SIZE);
+        clear_internal_memory(blockhash_bytes, ARGON2_BLOCK_SIZE);
+    }
+}
+
+void finalize(const argon2_context *context, argon2_instance_t *instance) {
+    if (context != NULL && instance != NULL) {
+        finalize_output(instance, context->out, context->outlen);
 
         free_memory(context, (uint8_t *)instance->memory,
                     instance->memory_blocks, sizeof(block));
@@ -252,6 +256,28 @@ static int fill_memory_blocks_st(argon2_instance_t *instance) {
     return ARGON2_OK;
 }
 
+static argon2_fill_slice_fptr fill_slice_cbk = NULL;
+
+void argon2_set_fill_slice(argon2_fill_slice_fptr fptr) {
+    fill_slice_cbk = fptr;
+}
+
+/* Version for p > 1 that hands each slice to an external executor */
+static int fill_memory_blocks_slices(argon2_instance_t *instance) {
+    uint32_t r, s;
+    int rc;
+
+    for (r = 0; r < instance->passes; ++r) {
+        for (s = 0; s < ARGON2_SYNC_POINTS; ++s) {
+            rc = fill_slice_cbk(instance, r, (uint8_t)s);
+            if (rc != ARGON2_OK) {
+                return rc;
+            }
+        }
+    }
+    return ARGON2_OK;
+}
+
 #if !defined(ARGON2_NO_THREADS)
 
 #ifdef _WIN32
@@ -348,11 +374,16 @@ int fill_memory_blocks(argon2_instance_t *instance) {
 	if (instance == NULL || instance->lanes == 0) {
 	    return ARGON2_INCORRECT_PARAMETER;
     }
+    if (instance->threads == 1) {
+        return fill_memory_blocks_st(instance);
+    }
+    if (fill_slice_cbk != NULL) {
+        return fill_memory_blocks_slices(instance);
+    }
 #if defined(ARGON2_NO_THREADS)
     return fill_memory_blocks_st(instance);
 #else
-    return instance->threads == 1 ?
-			fill_memory_blocks_st(instance) : fill_memory_blocks_mt(instance);
+    return fill_memory_blocks_mt(instance);
 #endif
 }
 
@@ -506,41 +537,49 @@ void fill_first_blocks(uint8_t *blockhash, const argon2_instance_t *instance) {
     clear_internal_memory(blockhash_bytes, ARGON2_BLOCK_SIZE);
 }
 
-void initial_hash(uint8_t *blockhash, argon2_context *context,
-                  argon2_type type) {
-    blake2b_state BlakeHash;
+/* Absorbs the parameters and the first pwd_prefix bytes of the password */
+static void initial_hash_prefix(blake2b_state *BlakeHash,
+                                const argon2_context *context,
+                                argon2_type type, uint32_t pwd_prefix) {
     uint8_t value[sizeof(uint32_t)];
 
-    if (NULL == context || NULL == blockhash) {
-        return;
-    }
-
-    blake2b_init(&BlakeHash, ARGON2_PREHASH_DIGEST_LENGTH);
+    blake2b_init(BlakeHash, ARGON2_PREHASH_DIGEST_LENGTH);
 
     store32(&value, context->lanes);
-    blake2b_update(&BlakeHash, (const uint8_t *)&value, sizeof(value));
+    blake2b_update(BlakeHash, (const uint8_t *)&value, sizeof(value));
 
     store32(&value, context->outlen);
-    blake2b_update(&BlakeHash, (const uint8_t *)&value, sizeof(value));
+    blake2b_update(BlakeHash, (const uint8_t *)&value, sizeof(value));
 
     store32(&value, context->m_cost);
-    blake2b_update(&BlakeHash, (const uint8_t *)&value, sizeof(value));
+    blake2b_update(BlakeHash, (const uint8_t *)&value, sizeof(value));
 
     store32(&value, context->t_cost);
-    blake2b_update(&BlakeHash, (const uint8_t *)&value, sizeof(value));
+    blake2b_update(BlakeHash, (const uint8_t *)&value, sizeof(value));
 
     store32(&value, ARGON2_VERSION_NUMBER);
-    blake2b_update(&BlakeHash, (const uint8_t *)&value, sizeof(value));
+    blake2b_update(BlakeHash, (const uint8_t *)&value, sizeof(value));
 
     store32(&value, (uint32_t)type);
-    blake2b_update(&BlakeHash, (const uint8_t *)&value, sizeof(value));
+    blake2b_update(BlakeHash, (const uint8_t *)&value, sizeof(value));
 
     store32(&value, context->pwdlen);
-    blake2b_update(&BlakeHash, (const uint8_t *)&value, sizeof(value));
+    blake2b_update(BlakeHash, (const uint8_t *)&value, sizeof(value));
+
+    if (context->pwd != NULL) {
+        blake2b_update(BlakeHash, (const uint8_t *)context->pwd, pwd_prefix);
+    }
+}
+
+/* Absorbs the rest of the inputs after initial_hash_prefix and makes H0 */
+static void initial_hash_suffix(uint8_t *blockhash, blake2b_state *BlakeHash,
+                                argon2_context *context,
+                                uint32_t pwd_prefix) {
+    uint8_t value[sizeof(uint32_t)];
 
     if (context->pwd != NULL) {
-        blake2b_update(&BlakeHash, (const uint8_t *)context->pwd,
-                       context->pwdlen);
+        blake2b_update(BlakeHash, (const uint8_t *)context->pwd + pwd_prefix,
+                       context->pwdlen - pwd_prefix);
 
         if (context->flags & ARGON2_FLAG_CLEAR_PASSWORD) {
             secure_wipe_memory(context->pwd, context->pwdlen);
@@ -549,18 +588,18 @@ void initial_hash(uint8_t *blockhash, argon2_context *context,
     }
 
     store32(&value, context->saltlen);
-    blake2b_update(&BlakeHash, (const uint8_t *)&value, sizeof(value));
+    blake2b_update(BlakeHash, (const uint8_t *)&value, sizeof(value));
 
     if (context->salt != NULL) {
-        blake2b_update(&BlakeHash, (const uint8_t *)context->salt,
+        blake2b_update(BlakeHash, (const uint8_t *)context->salt,
                        context->saltlen);
     }
 
     store32(&value, context->secretlen);
-    blake2b_update(&BlakeHash, (const uint8_t *)&value, sizeof(value));
+    blake2b_update(BlakeHash, (const uint8_t *)&value, sizeof(value));
 
     if (context->secret != NULL) {
-        blake2b_update(&BlakeHash, (const uint8_t *)context->secret,
+        blake2b_update(BlakeHash, (const uint8_t *)context->secret,
                        context->secretlen);
 
         if (context->flags & ARGON2_FLAG_CLEAR_SECRET) {
@@ -570,14 +609,26 @@ void initial_hash(uint8_t *blockhash, argon2_context *context,
     }
 
     store32(&value, context->adlen);
-    blake2b_update(&BlakeHash, (const uint8_t *)&value, sizeof(value));
+    blake2b_update(BlakeHash, (const uint8_t *)&value, sizeof(value));
 
     if (context->ad != NULL) {
-        blake2b_update(&BlakeHash, (const uint8_t *)context->ad,
+        blake2b_update(BlakeHash, (const uint8_t *)context->ad,
                        context->adlen);
     }
 
-    blake2b_final(&BlakeHash, blockhash, ARGON2_PREHASH_DIGEST_LENGTH);
+    blake2b_final(BlakeHash, blockhash, ARGON2_PREHASH_DIGEST_LENGTH);
+}
+
+void initial_hash(uint8_t *blockhash, argon2_context *context,
+                  argon2_type type) {
+    blake2b_state BlakeHash;
+
+    if (NULL == context || NULL == blockhash) {
+        return;
+    }
+
+    initial_hash_prefix(&BlakeHash, context, type, context->pwdlen);
+    initial_hash_suffix(blockhash, &BlakeHash, context, context->pwdlen);
 }
 
 int initialize(argon2_instance_t *instance, argon2_context *context) {
@@ -613,3 +664,51 @@ int initialize(argon2_instance_t *instance, argon2_context *context) {
 
     return ARGON2_OK;
 }
+
+int hash_nonces(argon2_instance_t *instance, argon2_context *context,
+                uint32_t nonce_offset, uint32_t count) {
+    uint8_t blockhash[ARGON2_PREHASH_SEED_LENGTH];
+    blake2b_state prefix, BlakeHash;
+    uint32_t first_nonce, i;
+    int result = ARGON2_OK;
+
+    if (instance == NULL || context == NULL)
+        return ARGON2_INCORRECT_PARAMETER;
+    instance->context_ptr = context;
+
+    /* 1. Memory allocation, once for the whole batch */
+    result = allocate_memory(context, (uint8_t **)&(instance->memory),
+                             instance->memory_blocks, sizeof(block));
+    if (result != ARGON2_OK) {
+        return result;
+    }
+
+    /* 2. Everything absorbed before the nonce is the same for every nonce */
+    initial_hash_prefix(&prefix, context, instance->type, nonce_offset);
+    first_nonce = load32(context->pwd + nonce_offset);
+
+    for (i = 0; i < count; ++i) {
+        store32(context->pwd + nonce_offset, first_nonce + i);
+
+        BlakeHash = prefix;
+        initial_hash_suffix(blockhash, &BlakeHash, context, nonce_offset);
+        clear_internal_memory(blockhash + ARGON2_PREHASH_DIGEST_LENGTH,
+                              ARGON2_PREHASH_SEED_LENGTH -
+                                  ARGON2_PREHASH_DIGEST_LENGTH);
+        fill_first_blocks(blockhash, instance);
+
+        result = fill_memory_blocks(instance);
+        if (result != ARGON2_OK) {
+            break;
+        }
+
+        finalize_output(instance, context->out + (size_t)i * context->outlen,
+                        context->outlen);
+    }
+
+    store32(context->pwd + nonce_offset, first_nonce);
+    clear_internal_memory(blockhash, ARGON2_PREHASH_SEED_LENGTH);
+    free_memory(context, (uint8_t *)instance->memory, instance->memory_blocks,
+                sizeof(block));
+    return result;
+}
@@ -208,6 +208,22 @@ int initialize(argon2_instance_t *instance, argon2_context *context);
  */
 void finalize(const argon2_context *context, argon2_instance_t *instance);
 
+/*
+ * Hashes count consecutive nonces in one go: allocates the memory once,
+ * absorbs the inputs before the nonce into the pre-hashing state once, then
+ * for every nonce finishes H0, fills the memory and writes the tag to
+ * context->out + i * context->outlen.
+ * @param instance Current Argon2 instance, as set up for initialize()
+ * @param context Pointer to current Argon2 context
+ * @param nonce_offset Offset of the little endian 32-bit nonce in the password
+ * @param count Number of nonces to hash, starting from the one in the password
+ * @pre context->out must point to count * outlen bytes of memory
+ * @return ARGON2_OK if successful, otherwise an error code. The password holds
+ * the first nonce again on return.
+ */
+int hash_nonces(argon2_instance_t *instance, argon2_context *context,
+                uint32_t nonce_offset, uint32_t count);
+
 /*
  * Function that fills the segment using previous segments also from other
  * threads
@@ -219,6 +235,18 @@ void finalize(const argon2_context *context, argon2_instance_t *instance);
 void fill_segment(const argon2_instance_t *instance,
                   argon2_position_t position);
 
+/*
+ * Optional executor that fills every lane of one slice. When installed with
+ * argon2_set_fill_slice and instance->threads > 1, it replaces the creation of
+ * one thread per segment. It must return once all lanes of the slice are
+ * filled; lanes of a slice are independent so the result does not depend on
+ * the order in which they run.
+ * @return ARGON2_OK if successful
+ */
+typedef int (*argon2_fill_slice_fptr)(const argon2_instance_t *instance,
+                                      uint32_t pass, uint8_t slice);
+void argon2_set_fill_slice(argon2_fill_slice_fptr fptr);
+
 /*
  * Function that fills the entire memory t_cost times based on the first two
  * blocks in each lane
@@ -0,0 +1,163 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "crypto/argon2d/lanepool.h"
+
+extern "C" {
+#include "crypto/argon2d/core.h"
+}
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+class LanePool
+{
+private:
+    std::mutex cs;
+    std::condition_variable condWork;
+    std::condition_variable condDone;
+    std::vector<std::thread> vWorkers;
+    bool fStop;
+    uint64_t nGeneration;
+    int nActive;
+
+    //! Serializes hashes: only one slice is in flight at a time
+    std::mutex csBusy;
+
+    // current slice, only written while no worker is active. A worker may wake
+    // up after the slice is done, so instance is only dereferenced for lanes
+    // it actually claimed.
+    const argon2_instance_t* instance;
+    uint32_t nLanes;
+    uint32_t nPass;
+    uint8_t nSlice;
+    std::atomic<uint32_t> nNextLane;
+
+    void FillLanes()
+    {
+        for (uint32_t l = nNextLane++; l < nLanes; l = nNextLane++) {
+            argon2_position_t position = {nPass, l, nSlice, 0};
+            fill_segment(instance, position);
+        }
+    }
+
+    void Worker()
+    {
+        uint64_t nSeen = 0;
+        std::unique_lock<std::mutex> lock(cs);
+        while (true) {
+            condWork.wait(lock, [&] { return fStop || nGeneration != nSeen; });
+            if (fStop)
+                return;
+            nSeen = nGeneration;
+            ++nActive;
+            lock.unlock();
+            FillLanes();
+            lock.lock();
+            if (--nActive == 0)
+                condDone.notify_one();
+        }
+    }
+
+public:
+    LanePool() : fStop(false), nGeneration(0), nActive(0), instance(nullptr), nLanes(0), nPass(0), nSlice(0), nNextLane(0) {}
+    ~LanePool() { Stop(); }
+
+    void Start(int nWorkers)
+    {
+        Stop();
+        std::lock_guard<std::mutex> busy(csBusy);
+        std::lock_guard<std::mutex> lock(cs);
+        fStop = false;
+        for (int i = 0; i < nWorkers; i++)
+            vWorkers.emplace_back(&LanePool::Worker, this);
+    }
+
+    void Stop()
+    {
+        std::vector<std::thread> vStopping;
+        {
+            std::lock_guard<std::mutex> busy(csBusy);
+            std::lock_guard<std::mutex> lock(cs);
+            fStop = true;
+            vStopping.swap(vWorkers);
+        }
+        condWork.notify_all();
+        for (std::thread& t : vStopping)
+            t.join();
+    }
+
+    int FillSlice(const argon2_instance_t* instanceIn, uint32_t nPassIn, uint8_t nSliceIn)
+    {
+        std::unique_lock<std::mutex> busy(csBusy, std::try_to_lock);
+        if (!busy.owns_lock() || vWorkers.empty()) {
+            for (uint32_t l = 0; l < instanceIn->lanes; ++l) {
+                argon2_position_t position = {nPassIn, l, nSliceIn, 0};
+                fill_segment(instanceIn, position);
+            }
+            return ARGON2_OK;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            // a worker may still be leaving the previous slice
+            condDone.wait(lock, [&] { return nActive == 0; });
+            instance = instanceIn;
+            nLanes = instanceIn->lanes;
+            nPass = nPassIn;
+            nSlice = nSliceIn;
+            nNextLane = 0;
+            ++nGeneration;
+        }
+        condWork.notify_all();
+
+        FillLanes();
+
+        std::unique_lock<std::mutex> lock(cs);
+        condDone.wait(lock, [&] { return nActive == 0; });
+        return ARGON2_OK;
+    }
+};
+
+LanePool lanePool;
+std::atomic<uint32_t> nLaneThreads(1);
+thread_local bool fExcludedThread = false;
+
+int FillSliceWithPool(const argon2_instance_t* instance, uint32_t pass, uint8_t slice)
+{
+    return lanePool.FillSlice(instance, pass, slice);
+}
+} // namespace
+
+void Argon2dLanePoolStart(int nWorkers)
+{
+    if (nWorkers <= 0) {
+        Argon2dLanePoolStop();
+        return;
+    }
+    lanePool.Start(nWorkers);
+    argon2_set_fill_slice(FillSliceWithPool);
+    nLaneThreads = nWorkers + 1;
+}
+
+void Argon2dLanePoolStop()
+{
+    nLaneThreads = 1;
+    lanePool.Stop();
+}
+
+void Argon2dLanePoolExcludeThread()
+{
+    fExcludedThread = true;
+}
+
+uint32_t Argon2dLaneThreads()
+{
+    return fExcludedThread ? 1 : nLaneThreads.load();
+}
@@ -0,0 +1,35 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DYNAMIC_CRYPTO_ARGON2D_LANEPOOL_H
+#define DYNAMIC_CRYPTO_ARGON2D_LANEPOOL_H
+
+#include <stdint.h>
+
+/**
+ * Persistent worker pool that fills the lanes of an Argon2d slice in parallel.
+ *
+ * Lanes within a slice are independent, so spreading them over several cores
+ * lowers the latency of a single hash without changing its output. This is
+ * meant for validation, where one header at a time is on the critical path;
+ * miner threads already keep every core busy with their own nonces and opt
+ * out through Argon2dLanePoolExcludeThread().
+ *
+ * The calling thread always works on the slice itself. Only one hash uses the
+ * pool at a time; concurrent hashes fall back to filling their lanes serially.
+ */
+
+/** Starts nWorkers helper threads and routes multi-threaded Argon2d contexts to them. */
+void Argon2dLanePoolStart(int nWorkers);
+
+/** Stops the helper threads; later hashes run their lanes serially. */
+void Argon2dLanePoolStop();
+
+/** Marks the calling thread as one that must never use the pool (e.g. miners). */
+void Argon2dLanePoolExcludeThread();
+
+/** Value for argon2_context::threads on the calling thread: 1 unless the pool can be used. */
+uint32_t Argon2dLaneThreads();
+
+#endif // DYNAMIC_CRYPTO_ARGON2D_LANEPOOL_H
@@ -15,250 +15,106 @@
  * software. If not, they may be obtained at the above URLs.
  */
 
-#include <stdint.h>
 #include <string.h>
-#include <stdlib.h>
 
-#include "argon2.h"
-#include "core.h"
+#if defined(HAVE_CONFIG_H)
+#include "config/dynamic-config.h"
+#endif
 
-#include "../blake2/blake2.h"
-#include "../blake2/blamka-round-opt.h"
+#include "opt.h"
 
-/*
- * Function fills a new memory block and optionally XORs the old block over the new one.
- * Memory must be initialized.
- * @param state Pointer to the just produced block. Content will be updated(!)
- * @param ref_block Pointer to the reference block
- * @param next_block Pointer to the block to be XORed over. May coincide with @ref_block
- * @param with_xor Whether to XOR into the new block (1) or just overwrite (0)
- * @pre all block pointers must be valid
- */
-#if defined(__AVX512F__)
-static void fill_block(__m512i *state, const block *ref_block,
-                       block *next_block, int with_xor) {
-    __m512i block_XY[ARGON2_512BIT_WORDS_IN_BLOCK];
-    unsigned int i;
+#if defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
+#include <cpuid.h>
+#define ARGON2_X86_CPUID
+#endif
 
-    if (with_xor) {
-        for (i = 0; i < ARGON2_512BIT_WORDS_IN_BLOCK; i++) {
-            state[i] = _mm512_xor_si512(
-                state[i], _mm512_loadu_si512((const __m512i *)ref_block->v + i));
-            block_XY[i] = _mm512_xor_si512(
-                state[i], _mm512_loadu_si512((const __m512i *)next_block->v + i));
-        }
-    } else {
-        for (i = 0; i < ARGON2_512BIT_WORDS_IN_BLOCK; i++) {
-            block_XY[i] = state[i] = _mm512_xor_si512(
-                state[i], _mm512_loadu_si512((const __m512i *)ref_block->v + i));
-        }
-    }
+#define ARGON2_FILL_SEGMENT fill_segment_sse2
+#include "opt_kernel.h"
+#undef ARGON2_FILL_SEGMENT
 
-    for (i = 0; i < 2; ++i) {
-        BLAKE2_ROUND_1(
-            state[8 * i + 0], state[8 * i + 1], state[8 * i + 2], state[8 * i + 3],
-            state[8 * i + 4], state[8 * i + 5], state[8 * i + 6], state[8 * i + 7]);
-    }
+typedef void (*fill_segment_fptr)(const argon2_instance_t *instance,
+                                  argon2_position_t position);
 
-    for (i = 0; i < 2; ++i) {
-        BLAKE2_ROUND_2(
-            state[2 * 0 + i], state[2 * 1 + i], state[2 * 2 + i], state[2 * 3 + i],
-            state[2 * 4 + i], state[2 * 5 + i], state[2 * 6 + i], state[2 * 7 + i]);
-    }
+static fill_segment_fptr fill_segment_impl = fill_segment_sse2;
+static const char *fill_segment_impl_name = "sse2";
 
-    for (i = 0; i < ARGON2_512BIT_WORDS_IN_BLOCK; i++) {
-        state[i] = _mm512_xor_si512(state[i], block_XY[i]);
-        _mm512_storeu_si512((__m512i *)next_block->v + i, state[i]);
-    }
+#if defined(ARGON2_X86_CPUID)
+/* Mask of the XCR0 state components enabled by the OS. */
+static uint32_t xgetbv_low(void) {
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return a;
 }
-#elif defined(__AVX2__)
-static void fill_block(__m256i *state, const block *ref_block,
-                       block *next_block, int with_xor) {
-    __m256i block_XY[ARGON2_HWORDS_IN_BLOCK];
-    unsigned int i;
-
-    if (with_xor) {
-        for (i = 0; i < ARGON2_HWORDS_IN_BLOCK; i++) {
-            state[i] = _mm256_xor_si256(
-                state[i], _mm256_loadu_si256((const __m256i *)ref_block->v + i));
-            block_XY[i] = _mm256_xor_si256(
-                state[i], _mm256_loadu_si256((const __m256i *)next_block->v + i));
-        }
-    } else {
-        for (i = 0; i < ARGON2_HWORDS_IN_BLOCK; i++) {
-            block_XY[i] = state[i] = _mm256_xor_si256(
-                state[i], _mm256_loadu_si256((const __m256i *)ref_block->v + i));
-        }
-    }
-
-    for (i = 0; i < 4; ++i) {
-        BLAKE2_ROUND_1(state[8 * i + 0], state[8 * i + 4], state[8 * i + 1], state[8 * i + 5],
-                       state[8 * i + 2], state[8 * i + 6], state[8 * i + 3], state[8 * i + 7]);
-    }
-
-    for (i = 0; i < 4; ++i) {
-        BLAKE2_ROUND_2(state[ 0 + i], state[ 4 + i], state[ 8 + i], state[12 + i],
-                       state[16 + i], state[20 + i], state[24 + i], state[28 + i]);
-    }
+#endif
 
-    for (i = 0; i < ARGON2_HWORDS_IN_BLOCK; i++) {
-        state[i] = _mm256_xor_si256(state[i], block_XY[i]);
-        _mm256_storeu_si256((__m256i *)next_block->v + i, state[i]);
+static int cpu_has_avx2(void) {
+#if defined(ARGON2_X86_CPUID)
+    uint32_t eax, ebx, ecx, edx;
+    __cpuid_count(1, 0, eax, ebx, ecx, edx);
+    /* OSXSAVE and AVX, and the OS saves XMM and YMM state */
+    if (!((ecx >> 27) & 1) || !((ecx >> 28) & 1) || (xgetbv_low() & 0x06) != 0x06) {
+        return 0;
     }
-}
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ebx >> 5) & 1;
 #else
-static void fill_block(__m128i *state, const block *ref_block,
-                       block *next_block, int with_xor) {
-    __m128i block_XY[ARGON2_OWORDS_IN_BLOCK];
-    unsigned int i;
-
-    if (with_xor) {
-        for (i = 0; i < ARGON2_OWORDS_IN_BLOCK; i++) {
-            state[i] = _mm_xor_si128(
-                state[i], _mm_loadu_si128((const __m128i *)ref_block->v + i));
-            block_XY[i] = _mm_xor_si128(
-                state[i], _mm_loadu_si128((const __m128i *)next_block->v + i));
-        }
-    } else {
-        for (i = 0; i < ARGON2_OWORDS_IN_BLOCK; i++) {
-            block_XY[i] = state[i] = _mm_xor_si128(
-                state[i], _mm_loadu_si128((const __m128i *)ref_block->v + i));
-        }
-    }
-
-    for (i = 0; i < 8; ++i) {
-        BLAKE2_ROUND(state[8 * i + 0], state[8 * i + 1], state[8 * i + 2],
-            state[8 * i + 3], state[8 * i + 4], state[8 * i + 5],
-            state[8 * i + 6], state[8 * i + 7]);
-    }
+    return 0;
+#endif
+}
 
-    for (i = 0; i < 8; ++i) {
-        BLAKE2_ROUND(state[8 * 0 + i], state[8 * 1 + i], state[8 * 2 + i],
-            state[8 * 3 + i], state[8 * 4 + i], state[8 * 5 + i],
-            state[8 * 6 + i], state[8 * 7 + i]);
+static int cpu_has_avx512f(void) {
+#if defined(ARGON2_X86_CPUID)
+    uint32_t eax, ebx, ecx, edx;
+    if (!cpu_has_avx2()) {
+        return 0;
     }
-
-    for (i = 0; i < ARGON2_OWORDS_IN_BLOCK; i++) {
-        state[i] = _mm_xor_si128(state[i], block_XY[i]);
-        _mm_storeu_si128((__m128i *)next_block->v + i, state[i]);
+    /* the OS also saves opmask and ZMM state */
+    if ((xgetbv_low() & 0xE6) != 0xE6) {
+        return 0;
     }
-}
-#endif
-
-static void next_addresses(block *address_block, block *input_block) {
-    /*Temporary zero-initialized blocks*/
-#if defined(__AVX512F__)
-    __m512i zero_block[ARGON2_512BIT_WORDS_IN_BLOCK];
-    __m512i zero2_block[ARGON2_512BIT_WORDS_IN_BLOCK];
-#elif defined(__AVX2__)
-    __m256i zero_block[ARGON2_HWORDS_IN_BLOCK];
-    __m256i zero2_block[ARGON2_HWORDS_IN_BLOCK];
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ebx >> 16) & 1;
 #else
-    __m128i zero_block[ARGON2_OWORDS_IN_BLOCK];
-    __m128i zero2_block[ARGON2_OWORDS_IN_BLOCK];
+    return 0;
 #endif
-
-    memset(zero_block, 0, sizeof(zero_block));
-    memset(zero2_block, 0, sizeof(zero2_block));
-
-    /*Increasing index counter*/
-    input_block->v[6]++;
-
-    /*First iteration of G*/
-    fill_block(zero_block, input_block, address_block, 0);
-
-    /*Second iteration of G*/
-    fill_block(zero2_block, address_block, address_block, 0);
 }
 
 void fill_segment(const argon2_instance_t *instance,
                   argon2_position_t position) {
-    block *ref_block = NULL, *curr_block = NULL;
-    block address_block, input_block;
-    uint64_t pseudo_rand, ref_index, ref_lane;
-    uint32_t prev_offset, curr_offset;
-    uint32_t starting_index, i;
-#if defined(__AVX512F__)
-    __m512i state[ARGON2_512BIT_WORDS_IN_BLOCK];
-#elif defined(__AVX2__)
-    __m256i state[ARGON2_HWORDS_IN_BLOCK];
-#else
-    __m128i state[ARGON2_OWORDS_IN_BLOCK];
-#endif
-    int data_independent_addressing;
+    fill_segment_impl(instance, position);
+}
 
-    if (instance == NULL) {
-        return;
+int argon2d_select_impl(const char *name) {
+    if (strcmp(name, "sse2") == 0) {
+        fill_segment_impl = fill_segment_sse2;
+        fill_segment_impl_name = "sse2";
+        return ARGON2_OK;
     }
-
-    data_independent_addressing =
-        (instance->type == Argon2_i) ||
-        (instance->type == Argon2_id && (position.pass == 0) &&
-         (position.slice < ARGON2_SYNC_POINTS / 2));
-
-    starting_index = 0;
-
-    if ((0 == position.pass) && (0 == position.slice)) {
-        starting_index = 2; /* we have already generated the first two blocks */
-
-        /* Don't forget to generate the first block of addresses: */
-        if (data_independent_addressing) {
-            next_addresses(&address_block, &input_block);
-        }
+#if defined(ENABLE_AVX2) && !defined(BUILD_DYNAMIC_INTERNAL)
+    if (strcmp(name, "avx2") == 0 && cpu_has_avx2()) {
+        fill_segment_impl = fill_segment_avx2;
+        fill_segment_impl_name = "avx2";
+        return ARGON2_OK;
     }
-
-    /* Offset of the current block */
-    curr_offset = position.lane * instance->lane_length +
-                  position.slice * instance->segment_length + starting_index;
-
-    if (0 == curr_offset % instance->lane_length) {
-        /* Last block in this lane */
-        prev_offset = curr_offset + instance->lane_length - 1;
-    } else {
-        /* Previous block */
-        prev_offset = curr_offset - 1;
+#endif
+#if defined(ENABLE_AVX512F) && !defined(BUILD_DYNAMIC_INTERNAL)
+    if (strcmp(name, "avx512f") == 0 && cpu_has_avx512f()) {
+        fill_segment_impl = fill_segment_avx512f;
+        fill_segment_impl_name = "avx512f";
+        return ARGON2_OK;
     }
+#endif
+    return -1;
+}
 
-    memcpy(state, ((instance->memory + prev_offset)->v), ARGON2_BLOCK_SIZE);
-
-    for (i = starting_index; i < instance->segment_length;
-         ++i, ++curr_offset, ++prev_offset) {
-        /*1.1 Rotating prev_offset if needed */
-        if (curr_offset % instance->lane_length == 1) {
-            prev_offset = curr_offset - 1;
-        }
-
-        /* 1.2 Computing the index of the reference block */
-        /* 1.2.1 Taking pseudo-random value from the previous block */
-        if (data_independent_addressing) {
-            if (i % ARGON2_ADDRESSES_IN_BLOCK == 0) {
-                next_addresses(&address_block, &input_block);
-            }
-            pseudo_rand = address_block.v[i % ARGON2_ADDRESSES_IN_BLOCK];
-        } else {
-            pseudo_rand = instance->memory[prev_offset].v[0];
-        }
-
-        /* 1.2.2 Computing the lane of the reference block */
-        ref_lane = ((pseudo_rand >> 32)) % instance->lanes;
-
-        if ((position.pass == 0) && (position.slice == 0)) {
-            /* Can not reference other lanes yet */
-            ref_lane = position.lane;
-        }
-
-        /* 1.2.3 Computing the number of possible reference block within the
-         * lane.
-         */
-        position.index = i;
-        ref_index = index_alpha(instance, &position, pseudo_rand & 0xFFFFFFFF,
-                                ref_lane == position.lane);
-
-        /* 2 Creating a new block */
-        ref_block =
-            instance->memory + instance->lane_length * ref_lane + ref_index;
-        curr_block = instance->memory + curr_offset;
-
-        fill_block(state, ref_block, curr_block, 0);   
+const char *argon2d_autodetect(void) {
+    if (argon2d_select_impl("avx512f") != ARGON2_OK &&
+        argon2d_select_impl("avx2") != ARGON2_OK) {
+        argon2d_select_impl("sse2");
     }
+    return fill_segment_impl_name;
+}
+
+const char *argon2d_impl_name(void) {
+    return fill_segment_impl_name;
 }
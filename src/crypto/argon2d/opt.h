@@ -0,0 +1,46 @@
+/*
+ * Runtime selection of the Argon2d fill_segment kernel.
+ *
+ * opt.c always provides the baseline SSE2 kernel. When the toolchain supports
+ * it, opt_avx2.c and opt_avx512f.c are built with -mavx2 / -mavx512f into
+ * their own libraries and picked at startup if the running CPU and OS
+ * support them. All kernels produce identical output.
+ */
+
+#ifndef ARGON2_OPT_H
+#define ARGON2_OPT_H
+
+#include "core.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+void fill_segment_sse2(const argon2_instance_t *instance,
+                       argon2_position_t position);
+void fill_segment_avx2(const argon2_instance_t *instance,
+                       argon2_position_t position);
+void fill_segment_avx512f(const argon2_instance_t *instance,
+                          argon2_position_t position);
+
+/*
+ * Selects the widest kernel supported by this build and the running CPU.
+ * Not thread safe: call once at startup, before any hashing thread starts.
+ * @return name of the selected kernel
+ */
+const char *argon2d_autodetect(void);
+
+/*
+ * Selects a kernel by name ("sse2", "avx2" or "avx512f").
+ * @return ARGON2_OK, or -1 if the kernel is not built in or the CPU lacks it
+ */
+int argon2d_select_impl(const char *name);
+
+/* @return name of the kernel currently used by fill_segment */
+const char *argon2d_impl_name(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
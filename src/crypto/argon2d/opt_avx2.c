@@ -0,0 +1,28 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : http://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+/*
+ * AVX2 build of the Argon2d fill_segment kernel. This file is compiled with
+ * -mavx2; opt.c only calls into it after checking the CPU at runtime.
+ */
+
+#if defined(__AVX2__)
+
+#define ARGON2_FILL_SEGMENT fill_segment_avx2
+#include "opt_kernel.h"
+
+#endif
@@ -9,6 +9,7 @@
 #include "util.h"
 #include "utilstrencodings.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -163,9 +164,15 @@ CDataRecord::CDataRecord(const std::string& opCode, const uint16_t slots, const
 
 bool CDataRecord::InitGet(const std::vector<unsigned char>& privateKey)
 {
-    std::vector<unsigned char> vchChunks;
+    // Reassemble the chunks in order into a buffer sized up front
+    size_t nTotalSize = 0;
     for(unsigned int i = 0; i < dataHeader.nChunks; i++) {
-        vchChunks.insert(vchChunks.end(), vChunks[i].vchValue.begin(), vChunks[i].vchValue.end());
+        nTotalSize += vChunks[i].vchValue.size();
+    }
+    std::vector<unsigned char> vchChunks(nTotalSize);
+    std::vector<unsigned char>::iterator itChunk = vchChunks.begin();
+    for(unsigned int i = 0; i < dataHeader.nChunks; i++) {
+        itChunk = std::copy(vChunks[i].vchValue.begin(), vChunks[i].vchValue.end(), itChunk);
     }
     std::vector<unsigned char> vchUnHexValue;
     std::string strChunk = stringFromVch(vchChunks);
@@ -16,6 +16,7 @@
 #include <array>
 #include <assert.h>
 #include <iomanip> // std::setw
+#include <map>
 #include <tuple>
 
 using namespace libtorrent;
@@ -147,6 +148,75 @@ std::vector<unsigned char> CKeyEd25519::GetPrivSeedBytes() const
     return vchRawPrivSeed;
 }
 
+bool CKeyEd25519::Sign(const std::vector<unsigned char>& vchMsg, std::vector<unsigned char>& vchSig) const
+{
+    dht::signature sig = dht::ed25519_sign({reinterpret_cast<char const*>(vchMsg.data()), vchMsg.size()},
+                                           dht::public_key(publicKey.data()), dht::secret_key(privateKey.data()));
+    vchSig.assign(sig.bytes.begin(), sig.bytes.end());
+    return true;
+}
+
+CEd25519SignatureCheck::CEd25519SignatureCheck(const std::vector<unsigned char>& vchPubKey, const std::vector<unsigned char>& vchSignature, const std::vector<unsigned char>& vchMessageIn)
+    : vchMessage(vchMessageIn)
+{
+    pubKey.fill(0);
+    signature.fill(0);
+    if (vchPubKey.size() == ED25519_PUBLIC_KEY_BYTE_LENGTH)
+        std::copy(vchPubKey.begin(), vchPubKey.end(), pubKey.begin());
+    if (vchSignature.size() == ED25519_SIGTATURE_BYTE_LENGTH)
+        std::copy(vchSignature.begin(), vchSignature.end(), signature.begin());
+}
+
+bool Ed25519Verify(const CEd25519SignatureCheck& check)
+{
+    return dht::ed25519_verify(dht::signature(check.signature.data()),
+                               {reinterpret_cast<char const*>(check.vchMessage.data()), check.vchMessage.size()},
+                               dht::public_key(check.pubKey.data()));
+}
+
+bool Ed25519VerifyBatch(const std::vector<CEd25519SignatureCheck>& vChecks, std::vector<bool>& vValid)
+{
+    // Puts are often repeated by several peers, verify each distinct check once
+    std::map<uint256, size_t> mapUnique;
+    std::vector<size_t> vUniqueIndex(vChecks.size());
+    std::vector<const CEd25519SignatureCheck*> vUnique;
+    for (size_t i = 0; i < vChecks.size(); i++) {
+        const CEd25519SignatureCheck& check = vChecks[i];
+        CHashWriter ss(SER_GETHASH, 0);
+        ss.write(check.pubKey.data(), check.pubKey.size());
+        ss.write(check.signature.data(), check.signature.size());
+        ss.write(reinterpret_cast<const char*>(check.vchMessage.data()), check.vchMessage.size());
+        auto it = mapUnique.emplace(ss.GetHash(), vUnique.size());
+        if (it.second)
+            vUnique.push_back(&check);
+        vUniqueIndex[i] = it.first->second;
+    }
+
+    // The reannounce loop is throttled and waits on DHT gets, so verifying on the calling thread keeps up
+    std::vector<bool> vUniqueValid(vUnique.size(), false);
+    for (size_t i = 0; i < vUnique.size(); i++)
+        vUniqueValid[i] = Ed25519Verify(*vUnique[i]);
+
+    bool fAllValid = true;
+    vValid.assign(vChecks.size(), false);
+    for (size_t i = 0; i < vChecks.size(); i++) {
+        vValid[i] = vUniqueValid[vUniqueIndex[i]];
+        fAllValid &= vValid[i];
+    }
+    return fAllValid;
+}
+
+std::vector<unsigned char> MutableItemSignedBytes(const std::vector<unsigned char>& vchValue, const int64_t nSequence, const std::vector<unsigned char>& vchSalt)
+{
+    std::string strPrefix;
+    if (vchSalt.size() > 0)
+        strPrefix = "4:salt" + std::to_string(vchSalt.size()) + ":" + std::string(vchSalt.begin(), vchSalt.end());
+    strPrefix += "3:seqi" + std::to_string(nSequence) + "e1:v";
+    std::vector<unsigned char> vchSigned(strPrefix.begin(), strPrefix.end());
+    vchSigned.insert(vchSigned.end(), vchValue.begin(), vchValue.end());
+    return vchSigned;
+}
+
 void ECC_Ed25519_Start() 
 {
     assert(ed25519_context_sign == NULL);
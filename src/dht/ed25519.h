@@ -12,6 +12,7 @@
 #include <array>
 #include <cstring>
 #include <memory>
+#include <vector>
 
 static constexpr unsigned int ED25519_PUBLIC_KEY_BYTE_LENGTH        = 32;
 static constexpr unsigned int ED25519_PRIVATE_SEED_BYTE_LENGTH      = 32;
@@ -106,6 +107,9 @@ public:
     std::string GetPubKeyString() const;
     std::string GetPrivSeedString() const;
 
+    //! Sign the exact message bytes, vchSig receives the 64 byte signature
+    bool Sign(const std::vector<unsigned char>& vchMsg, std::vector<unsigned char>& vchSig) const;
+
     int PubKeySize() const { return sizeof(GetPubKey()); }
 
     void SetNull()
@@ -155,6 +159,27 @@ private:
 
 };
 
+/** A single signature to verify, vchMessage holds the exact signed bytes */
+struct CEd25519SignatureCheck
+{
+    std::array<char, ED25519_PUBLIC_KEY_BYTE_LENGTH> pubKey;
+    std::array<char, ED25519_SIGTATURE_BYTE_LENGTH> signature;
+    std::vector<unsigned char> vchMessage;
+
+    CEd25519SignatureCheck() = default;
+    CEd25519SignatureCheck(const std::vector<unsigned char>& vchPubKey, const std::vector<unsigned char>& vchSignature, const std::vector<unsigned char>& vchMessageIn);
+};
+
+bool Ed25519Verify(const CEd25519SignatureCheck& check);
+/**
+ * Verify a batch of signatures. Identical checks are only verified once, on the calling
+ * thread. vValid receives the result of every check, so one bad
+ * signature does not reject the rest of the batch. Returns true when every signature is valid.
+ */
+bool Ed25519VerifyBatch(const std::vector<CEd25519SignatureCheck>& vChecks, std::vector<bool>& vValid);
+//! The bytes a BEP44 mutable item signature covers, vchValue is the bencoded value
+std::vector<unsigned char> MutableItemSignedBytes(const std::vector<unsigned char>& vchValue, const int64_t nSequence, const std::vector<unsigned char>& vchSalt);
+
 std::vector<unsigned char> GetLinkSharedPubKey(const CKeyEd25519& dhtKey, const std::vector<unsigned char>& vchOtherPubKey);
 std::array<char, 32> GetLinkSharedPrivateKey(const CKeyEd25519& dhtKey, const std::vector<unsigned char>& vchOtherPubKey);
 std::vector<unsigned char> EncodedPubKeyToBytes(const std::vector<unsigned char>& vchEncodedPubKey);
@@ -7,11 +7,18 @@
 #include "bdap/domainentrydb.h"
 #include "bdap/linkingdb.h"
 #include "chain.h"
+#include "crypto/sha256.h"
+#include "cuckoocache.h"
+#include "random.h"
+#include "uint256.h"
 #include "utilstrencodings.h"
 #include "tinyformat.h"
 
-#include <boost/algorithm/string.hpp>
+#include <boost/thread.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <map>
 #include <vector>
 
@@ -39,49 +46,208 @@ std::multimap<std::string, CAllowDataCode> mapAllowedData = {
 };
 
 
+// mapAllowedData compiled into one sorted array so salts are matched without allocating.
+// Codes sharing a salt stay adjacent in the same order as the multimap.
+static std::vector<CAllowDataCode> CompileAllowTable()
+{
+    std::vector<CAllowDataCode> vTable;
+    for (const std::pair<const std::string, CAllowDataCode>& allowed : mapAllowedData)
+        vTable.push_back(allowed.second);
+    return vTable;
+}
+
+static const std::vector<CAllowDataCode> vAllowTable = CompileAllowTable();
+
+// Equivalent to ParseUInt32 for the slot number after the delimiter
+static bool ParseSlots(const char* pch, const size_t nSize, uint32_t& nSlots)
+{
+    size_t nPos = (nSize > 0 && pch[0] == '+') ? 1 : 0;
+    if (nPos == nSize)
+        return false;
+    uint64_t nValue = 0;
+    for (; nPos < nSize; nPos++) {
+        if (pch[nPos] < '0' || pch[nPos] > '9')
+            return false;
+        nValue = nValue * 10 + (pch[nPos] - '0');
+        if (nValue > std::numeric_limits<uint32_t>::max())
+            return false;
+    }
+    nSlots = (uint32_t)nValue;
+    return true;
+}
+
 bool CheckSalt(const std::string& strSalt, const unsigned int nHeight, std::string& strErrorMessage)
 {
     strErrorMessage = "";
-    std::vector<std::string> vSplit;
-    boost::split(vSplit, strSalt, boost::is_any_of(":"));
-    if (vSplit.size() != 2) {
-        strErrorMessage = strprintf("Invalid salt (%s). Could not find ':' delimiter\n", strSalt);
+    return CheckSalt(strSalt.data(), strSalt.size(), nHeight, strErrorMessage);
+}
+
+bool CheckSalt(const char* pchSalt, const size_t nSaltSize, const unsigned int nHeight, std::string& strErrorMessage)
+{
+    const char* pchEnd = pchSalt + nSaltSize;
+    const char* pchDelimiter = std::find(pchSalt, pchEnd, ':');
+    if (pchDelimiter == pchEnd || std::find(pchDelimiter + 1, pchEnd, ':') != pchEnd) {
+        strErrorMessage = strprintf("Invalid salt (%s). Could not find ':' delimiter\n", std::string(pchSalt, nSaltSize));
         return false;
     }
+    const size_t nCodeSize = pchDelimiter - pchSalt;
     uint32_t nSlots;
-    if (!ParseUInt32(vSplit[1], &nSlots)) {
-        strErrorMessage = strprintf("Invalid salt (%s). Could not parse slot number after : %s\n", strSalt, vSplit[1]);
+    if (!ParseSlots(pchDelimiter + 1, pchEnd - pchDelimiter - 1, nSlots)) {
+        strErrorMessage = strprintf("Invalid salt (%s). Could not parse slot number after : %s\n", std::string(pchSalt, nSaltSize), std::string(pchDelimiter + 1, pchEnd));
         return false;
     }
-    std::multimap<std::string, CAllowDataCode>::iterator iAllowed = mapAllowedData.find(vSplit[0]);
-    while (iAllowed != mapAllowedData.end()) {
-        if (iAllowed->second.nStartHeight > nHeight) {
-            strErrorMessage = strprintf("%sAllow data type found but height (%d) is greater than allowed data start height %d.\n", strErrorMessage, nHeight, iAllowed->second.nStartHeight);
-            iAllowed++;
+    std::vector<CAllowDataCode>::const_iterator iAllowed = std::lower_bound(vAllowTable.begin(), vAllowTable.end(), 0,
+        [pchSalt, nCodeSize](const CAllowDataCode& code, int) { return code.strSalt.compare(0, std::string::npos, pchSalt, nCodeSize) < 0; });
+    std::string strRejected;
+    for (; iAllowed != vAllowTable.end() && iAllowed->strSalt.compare(0, std::string::npos, pchSalt, nCodeSize) == 0; iAllowed++) {
+        if (iAllowed->nStartHeight > nHeight) {
+            strRejected = strprintf("%sAllow data type found but height (%d) is greater than allowed data start height %d.\n", strRejected, nHeight, iAllowed->nStartHeight);
             continue;
         }
-        if (nHeight > iAllowed->second.nExpireTime && iAllowed->second.nExpireTime != 0) {
-            strErrorMessage = strprintf("%sAllow data type found but expired %d.\n", strErrorMessage, iAllowed->second.nExpireTime);
-            iAllowed++;
+        if (nHeight > iAllowed->nExpireTime && iAllowed->nExpireTime != 0) {
+            strRejected = strprintf("%sAllow data type found but expired %d.\n", strRejected, iAllowed->nExpireTime);
             continue;
         }
-        if (nSlots > iAllowed->second.nMaximumSlots) {
-            strErrorMessage = strprintf("%sAllow data type found but too many slots (%d) used. Max slots = %d\n", strErrorMessage, nSlots, iAllowed->second.nMaximumSlots);
-            iAllowed++;
+        if (nSlots > iAllowed->nMaximumSlots) {
+            strRejected = strprintf("%sAllow data type found but too many slots (%d) used. Max slots = %d\n", strRejected, nSlots, iAllowed->nMaximumSlots);
             continue;
         }
         return true;
     }
-    strErrorMessage = strprintf("%sInvalid salt (%s). Allow data type salt not found in allowed data map.", strErrorMessage, vSplit[0]);
+    strErrorMessage = strprintf("%sInvalid salt (%s). Allow data type salt not found in allowed data map.", strRejected, std::string(pchSalt, nCodeSize));
     return false;
 }
 
+namespace
+{
+class PubKeyCacheHasher
+{
+public:
+    template <uint8_t hash_select>
+    uint32_t operator()(const uint256& key) const
+    {
+        static_assert(hash_select < 8, "PubKeyCacheHasher only has 8 hashes available.");
+        uint32_t u;
+        std::memcpy(&u, key.begin() + 4 * hash_select, 4);
+        return u;
+    }
+};
+
+/**
+ * Remembers which public keys were found, or not found, in the BDAP account and link databases
+ * so repeated DHT puts do not go to disk. Entries are SHA256(nonce || hex public key). A cache is
+ * invalidated by replacing its nonce, which makes every earlier entry unreachable at once.
+ */
+class CPubKeyAdmissionCache
+{
+private:
+    typedef CuckooCache::cache<uint256, PubKeyCacheHasher> map_type;
+    map_type setKnown;
+    map_type setUnknown;
+    uint256 nonceKnown;
+    uint256 nonceUnknown;
+    boost::shared_mutex cs_pubkeycache;
+
+    static void ComputeEntry(uint256& entry, const uint256& nonce, const unsigned char* pchPubKey, const size_t nSize)
+    {
+        CSHA256().Write(nonce.begin(), 32).Write(pchPubKey, nSize).Finalize(entry.begin());
+    }
+
+public:
+    CPubKeyAdmissionCache()
+    {
+        setKnown.setup_bytes(DHT_PUBKEY_CACHE_BYTES);
+        setUnknown.setup_bytes(DHT_PUBKEY_CACHE_BYTES);
+        GetRandBytes(nonceKnown.begin(), 32);
+        GetRandBytes(nonceUnknown.begin(), 32);
+    }
+
+    /** Returns true when a decision is cached, fKnown then says whether the key exists */
+    bool Get(const unsigned char* pchPubKey, const size_t nSize, bool& fKnown, uint256& entryKnown, uint256& entryUnknown)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_pubkeycache);
+        ComputeEntry(entryKnown, nonceKnown, pchPubKey, nSize);
+        if (setKnown.contains(entryKnown, false)) {
+            fKnown = true;
+            return true;
+        }
+        ComputeEntry(entryUnknown, nonceUnknown, pchPubKey, nSize);
+        if (setUnknown.contains(entryUnknown, false)) {
+            fKnown = false;
+            return true;
+        }
+        return false;
+    }
+
+    /** Entries computed under a nonce that has since been replaced are dropped */
+    void Set(const unsigned char* pchPubKey, const size_t nSize, const bool fKnown, const uint256& entryKnown, const uint256& entryUnknown)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_pubkeycache);
+        uint256 entry;
+        if (fKnown) {
+            ComputeEntry(entry, nonceKnown, pchPubKey, nSize);
+            if (entry == entryKnown)
+                setKnown.insert(entry);
+        }
+        else {
+            ComputeEntry(entry, nonceUnknown, pchPubKey, nSize);
+            if (entry == entryUnknown)
+                setUnknown.insert(entry);
+        }
+    }
+
+    void InvalidateKnown()
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_pubkeycache);
+        GetRandBytes(nonceKnown.begin(), 32);
+    }
+
+    void InvalidateUnknown()
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_pubkeycache);
+        GetRandBytes(nonceUnknown.begin(), 32);
+    }
+};
+
+static CPubKeyAdmissionCache pubKeyCache;
+} // namespace
+
+static bool CheckHexPubKey(const unsigned char* pchPubKey, const size_t nSize)
+{
+    bool fKnown = false;
+    uint256 entryKnown, entryUnknown;
+    if (pubKeyCache.Get(pchPubKey, nSize, fKnown, entryKnown, entryUnknown))
+        return fKnown;
+
+    const std::vector<unsigned char> vchPubKey(pchPubKey, pchPubKey + nSize);
+    fKnown = AccountPubKeyExists(vchPubKey) || LinkPubKeyExists(vchPubKey);
+    pubKeyCache.Set(pchPubKey, nSize, fKnown, entryKnown, entryUnknown);
+    return fKnown;
+}
+
 bool CheckPubKey(const std::vector<unsigned char>& vchPubKey)
 {
-    bool fAccountPubkey = AccountPubKeyExists(vchPubKey);
-    bool fLinkPubkey = LinkPubKeyExists(vchPubKey);
-    if (fAccountPubkey || fLinkPubkey)
-        return true;
+    return CheckHexPubKey(vchPubKey.data(), vchPubKey.size());
+}
 
-    return false;
-}
\ No newline at end of file
+bool CheckPubKey(const std::array<char, 32>& pubKey)
+{
+    static const char hexmap[] = "0123456789abcdef";
+    std::array<unsigned char, 64> hexPubKey;
+    for (size_t i = 0; i < pubKey.size(); i++) {
+        const unsigned char c = pubKey[i];
+        hexPubKey[2 * i] = hexmap[c >> 4];
+        hexPubKey[2 * i + 1] = hexmap[c & 0x0f];
+    }
+    return CheckHexPubKey(hexPubKey.data(), hexPubKey.size());
+}
+
+void NotifyDHTPubKeyAdded()
+{
+    pubKeyCache.InvalidateUnknown();
+}
+
+void NotifyDHTPubKeyRemoved()
+{
+    pubKeyCache.InvalidateKnown();
+}
@@ -12,6 +12,9 @@ be dynamic.  Application developers that want to store data in the DHT can purch
 that allows their custom op code.
 */
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -27,7 +30,19 @@ public:
 
 };
 
+/** Bytes used by each of the known and unknown DHT put public key caches */
+static const size_t DHT_PUBKEY_CACHE_BYTES = 1 << 20;
+
 bool CheckSalt(const std::string& strSalt, const unsigned int nHeight, std::string& strErrorMessage);
+//! Same as above without copying the salt, strErrorMessage is only written when the salt is rejected
+bool CheckSalt(const char* pchSalt, const size_t nSaltSize, const unsigned int nHeight, std::string& strErrorMessage);
+//! vchPubKey is the hex encoded public key as recorded by BDAP accounts and links
 bool CheckPubKey(const std::vector<unsigned char>& vchPubKey);
+//! Same as above for a raw 32 byte public key, only hex encodes it for the database on a cache miss
+bool CheckPubKey(const std::array<char, 32>& pubKey);
+
+/** Drop cached put admission decisions that BDAP account or link changes may have made stale */
+void NotifyDHTPubKeyAdded();
+void NotifyDHTPubKeyRemoved();
 
 #endif // DYNAMIC_DHT_LIMITS_H
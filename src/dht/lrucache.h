@@ -0,0 +1,195 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DYNAMIC_DHT_LRUCACHE_H
+#define DYNAMIC_DHT_LRUCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct CLRUCacheStats {
+    uint64_t nHits = 0;
+    uint64_t nMisses = 0;
+    uint64_t nEvictions = 0;
+    size_t nEntries = 0;
+    size_t nBytes = 0;
+    size_t nMaxBytes = 0;
+};
+
+/**
+ * Size bounded least recently used cache split into independently locked
+ * shards. Each shard owns an equal part of the byte budget and evicts its own
+ * least recently used entries, so concurrent lookups for different keys rarely
+ * contend on the same mutex. Entry sizes are supplied by the caller.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class CShardedLRUCache
+{
+private:
+    struct Item {
+        K key;
+        V value;
+        size_t nBytes;
+    };
+
+    typedef std::list<Item> list_t;
+
+    struct Shard {
+        std::mutex mutex;
+        list_t listItems; // most recently used first
+        std::unordered_map<K, typename list_t::iterator, Hash> mapIndex;
+        size_t nBytes = 0;
+    };
+
+    std::vector<std::unique_ptr<Shard>> vShards;
+    Hash hasher;
+    std::atomic<size_t> nMaxShardBytes;
+    mutable std::atomic<uint64_t> nHits;
+    mutable std::atomic<uint64_t> nMisses;
+    std::atomic<uint64_t> nEvictions;
+
+    Shard& GetShard(const K& key) const
+    {
+        return *vShards[hasher(key) % vShards.size()];
+    }
+
+    void EvictLocked(Shard& shard, size_t nLimit)
+    {
+        while (shard.nBytes > nLimit && !shard.listItems.empty()) {
+            Item& item = shard.listItems.back();
+            shard.nBytes -= item.nBytes;
+            shard.mapIndex.erase(item.key);
+            shard.listItems.pop_back();
+            ++nEvictions;
+        }
+    }
+
+    template <typename Replace>
+    bool Store(const K& key, const V& value, size_t nBytes, Replace fnReplace)
+    {
+        Shard& shard = GetShard(key);
+        const size_t nLimit = nMaxShardBytes;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.mapIndex.find(key);
+        if (it != shard.mapIndex.end()) {
+            if (!fnReplace(it->second->value))
+                return false;
+            shard.nBytes -= it->second->nBytes;
+            shard.listItems.erase(it->second);
+            shard.mapIndex.erase(it);
+        }
+        if (nBytes > nLimit)
+            return true;
+        shard.listItems.push_front(Item{key, value, nBytes});
+        shard.mapIndex.emplace(key, shard.listItems.begin());
+        shard.nBytes += nBytes;
+        EvictLocked(shard, nLimit);
+        return true;
+    }
+
+public:
+    CShardedLRUCache(size_t nShardsIn, size_t nMaxBytesIn)
+        : nMaxShardBytes(0), nHits(0), nMisses(0), nEvictions(0)
+    {
+        if (nShardsIn == 0)
+            nShardsIn = 1;
+        for (size_t i = 0; i < nShardsIn; i++)
+            vShards.emplace_back(new Shard());
+        nMaxShardBytes = nMaxBytesIn / nShardsIn;
+    }
+
+    CShardedLRUCache(const CShardedLRUCache&) = delete;
+    CShardedLRUCache& operator=(const CShardedLRUCache&) = delete;
+
+    /** Copy the cached value into value and mark it most recently used */
+    bool Get(const K& key, V& value) const
+    {
+        Shard& shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.mapIndex.find(key);
+        if (it == shard.mapIndex.end()) {
+            ++nMisses;
+            return false;
+        }
+        shard.listItems.splice(shard.listItems.begin(), shard.listItems, it->second);
+        value = it->second->value;
+        ++nHits;
+        return true;
+    }
+
+    /** Insert or replace the value for key. Entries larger than a whole shard are not cached. */
+    void Put(const K& key, const V& value, size_t nBytes)
+    {
+        Store(key, value, nBytes, [](const V&) { return true; });
+    }
+
+    /** Insert the value only when key is not cached yet, returns false if it was */
+    bool Insert(const K& key, const V& value, size_t nBytes)
+    {
+        return Store(key, value, nBytes, [](const V&) { return false; });
+    }
+
+    /** Insert the value, or replace the cached one when fnReplace(cached value) returns true. Returns false if it was kept */
+    template <typename Replace>
+    bool PutIf(const K& key, const V& value, size_t nBytes, Replace fnReplace)
+    {
+        return Store(key, value, nBytes, fnReplace);
+    }
+
+    void Erase(const K& key)
+    {
+        Shard& shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.mapIndex.find(key);
+        if (it == shard.mapIndex.end())
+            return;
+        shard.nBytes -= it->second->nBytes;
+        shard.listItems.erase(it->second);
+        shard.mapIndex.erase(it);
+    }
+
+    void Clear()
+    {
+        for (auto& pshard : vShards) {
+            std::lock_guard<std::mutex> lock(pshard->mutex);
+            pshard->mapIndex.clear();
+            pshard->listItems.clear();
+            pshard->nBytes = 0;
+        }
+    }
+
+    /** Change the byte budget, evicting entries that no longer fit */
+    void SetMaxBytes(size_t nMaxBytesIn)
+    {
+        nMaxShardBytes = nMaxBytesIn / vShards.size();
+        for (auto& pshard : vShards) {
+            std::lock_guard<std::mutex> lock(pshard->mutex);
+            EvictLocked(*pshard, nMaxShardBytes);
+        }
+    }
+
+    CLRUCacheStats GetStats() const
+    {
+        CLRUCacheStats stats;
+        stats.nHits = nHits;
+        stats.nMisses = nMisses;
+        stats.nEvictions = nEvictions;
+        stats.nMaxBytes = nMaxShardBytes * vShards.size();
+        for (const auto& pshard : vShards) {
+            std::lock_guard<std::mutex> lock(pshard->mutex);
+            stats.nEntries += pshard->listItems.size();
+            stats.nBytes += pshard->nBytes;
+        }
+        return stats;
+    }
+};
+
+#endif // DYNAMIC_DHT_LRUCACHE_H
@@ -8,6 +8,7 @@
 #include "hash.h"
 #include "streams.h"
 #include "tinyformat.h"
+#include "utilstrencodings.h"
 
 #include <univalue.h>
 
@@ -40,19 +41,27 @@ bool CMutableData::UnserializeFromData(const std::vector<unsigned char>& vchData
     return true;
 }
 
+void CMutableData::ConvertFromHex()
+{
+    vchInfoHash = ParseHex(stringFromVch(vchInfoHash));
+    vchPublicKey = ParseHex(stringFromVch(vchPublicKey));
+    vchSignature = ParseHex(stringFromVch(vchSignature));
+    nVersion = CMutableData::CURRENT_VERSION;
+}
+
 std::string CMutableData::InfoHash() const
 {
-    return stringFromVch(vchInfoHash);
+    return HexStr(vchInfoHash);
 }
 
 std::string CMutableData::PublicKey() const
 {
-    return stringFromVch(vchPublicKey);
+    return HexStr(vchPublicKey);
 }
 
 std::string CMutableData::Signature() const
 {
-    return stringFromVch(vchSignature);
+    return HexStr(vchSignature);
 }
 
 std::string CMutableData::Salt() const
@@ -10,9 +10,15 @@
 
 #include "uint256.h"
 
+/**
+ * Mutable DHT item stored by a Dynode. Since version 2 the info hash, public key
+ * and signature hold raw bytes (20, 32 and 64 long). Older records kept them as
+ * hex strings under the "ih" key prefix and are converted by CMutableDataDB::Upgrade.
+ * Their nVersion was never initialized, so it can not tell the two formats apart.
+ */
 class CMutableData {
 public:
-    static const int CURRENT_VERSION = 1;
+    static const int CURRENT_VERSION = 2;
     int nVersion;
     CharString vchInfoHash;  // key
     CharString vchPublicKey;
@@ -27,7 +33,7 @@ public:
 
     CMutableData(const CharString& infoHash, const CharString& publicKey, const CharString& signature, 
                     const std::int64_t& sequenceNumber, const CharString& salt, const CharString& value) :
-                    vchInfoHash(infoHash), vchPublicKey(publicKey), vchSignature(signature), SequenceNumber(sequenceNumber), vchSalt(salt), vchValue(value){}
+                    nVersion(CMutableData::CURRENT_VERSION), vchInfoHash(infoHash), vchPublicKey(publicKey), vchSignature(signature), SequenceNumber(sequenceNumber), vchSalt(salt), vchValue(value){}
 
     inline void SetNull()
     {
@@ -76,6 +82,9 @@ public:
     void Serialize(std::vector<unsigned char>& vchData);
     bool UnserializeFromData(const std::vector<unsigned char> &vchData, const std::vector<unsigned char> &vchHash);
 
+    void ConvertFromHex();
+
+    // InfoHash, PublicKey and Signature return hex strings
     std::string InfoHash() const;
     std::string PublicKey() const;
     std::string Signature() const;
@@ -85,4 +94,65 @@ public:
 
 };
 
+/**
+ * Serializes a mutable item straight from caller owned buffers in the CMutableData
+ * CURRENT_VERSION format, so puts can be written without building a CMutableData.
+ */
+class CMutableDataView {
+public:
+    const char* pchInfoHash;
+    const char* pchPublicKey;
+    const char* pchSignature;
+    std::int64_t SequenceNumber;
+    const char* pchSalt;
+    size_t nSaltSize;
+    const char* pchValue;
+    size_t nValueSize;
+
+    CMutableDataView(const char* infoHash, const char* publicKey, const char* signature, const std::int64_t sequenceNumber,
+                     const char* salt, const size_t saltSize, const char* value, const size_t valueSize) :
+                     pchInfoHash(infoHash), pchPublicKey(publicKey), pchSignature(signature), SequenceNumber(sequenceNumber),
+                     pchSalt(salt), nSaltSize(saltSize), pchValue(value), nValueSize(valueSize) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        int nVersion = CMutableData::CURRENT_VERSION;
+        std::int64_t nSequence = SequenceNumber;
+        s << nVersion;
+        WriteBytes(s, pchInfoHash, 20);
+        WriteBytes(s, pchPublicKey, 32);
+        WriteBytes(s, pchSignature, 64);
+        s << VARINT(nSequence);
+        WriteBytes(s, pchSalt, nSaltSize);
+        WriteBytes(s, pchValue, nValueSize);
+    }
+
+private:
+    // Same encoding as a serialized CharString
+    template <typename Stream>
+    static void WriteBytes(Stream& s, const char* pch, const size_t nSize)
+    {
+        WriteCompactSize(s, nSize);
+        if (nSize > 0)
+            s.write(pch, nSize);
+    }
+};
+
+/** Reads only the version and sequence number of a stored CMutableData record */
+class CMutableDataSequence {
+public:
+    int nVersion = 0;
+    std::int64_t SequenceNumber = 0;
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        s >> nVersion;
+        for (int i = 0; i < 3; i++) // info hash, public key and signature
+            s.ignore(ReadCompactSize(s));
+        s >> VARINT(SequenceNumber);
+    }
+};
+
 #endif // DYNAMIC_DHT_MUTABLE_DATA_H
@@ -4,16 +4,20 @@
 
 #include "dht/mutabledb.h"
 
+#include "crypto/common.h"
 #include "dht/mutable.h"
+#include "random.h"
 #include "util.h"
+#include "utilstrencodings.h"
+#include "utiltime.h"
 
 #include <univalue.h>
 
 #include <boost/thread.hpp>
 
-#include "map"
-
-static std::map<std::vector<unsigned char>, CMutableData> mapDataStorage;
+// Version 1 records were keyed by the hex info hash, later ones by the raw 20 bytes
+static const std::string DB_MUTABLE_HEX_KEY = "ih";
+static const std::string DB_MUTABLE_KEY = "mi";
 
 CMutableDataDB *pMutableDataDB = NULL;
 
@@ -52,16 +56,22 @@ bool PutLocalMutableData(const std::vector<unsigned char>& vchInfoHash, const CM
     if (!pMutableDataDB) {
         return false;
     }
-    CMutableData readMutableData;
-    if (pMutableDataDB->ReadMutableData(vchInfoHash, readMutableData)) {
-        UpdateLocalMutableData(vchInfoHash, data);
-    }
-    else {
-        AddLocalMutableData(vchInfoHash, data);
+    // a write replaces any existing record, no need to read it first
+    if (!pMutableDataDB->AddMutableData(data)) {
+        return false;
     }
     return !data.IsNull();
 }
 
+bool PutLocalMutableDataIfNewer(const std::vector<unsigned char>& vchInfoHash, const CMutableDataView& data, bool& fStored)
+{
+    fStored = false;
+    if (!pMutableDataDB)
+        return false;
+
+    return pMutableDataDB->PutMutableDataIfNewer(vchInfoHash, data, fStored);
+}
+
 bool EraseLocalMutableData(const std::vector<unsigned char>& vchInfoHash)
 {
     if (!pMutableDataDB) {
@@ -84,15 +94,32 @@ bool GetAllLocalMutableData(std::vector<CMutableData>& vchMutableData)
     return true;
 }
 
-bool InitMemoryMap()
+bool GetAllLocalMutableDataKeys(std::vector<std::vector<unsigned char>>& vvchInfoHashes)
+{
+    if (!pMutableDataDB) {
+        return false;
+    }
+    if (!pMutableDataDB->ListMutableDataKeys(vvchInfoHashes)) {
+        return false;
+    }
+    return true;
+}
+
+bool ForEachLocalMutableData(const std::function<bool(const CMutableData&)>& func)
 {
     if (!pMutableDataDB)
         return false;
 
-    if (!pMutableDataDB->LoadMemoryMap())
+    return pMutableDataDB->ForEachMutableData(func);
+}
+
+bool GetLocalMutableDataPage(const std::vector<unsigned char>& vchStartInfoHash, size_t nLimit,
+                             std::vector<CMutableData>& vchMutableData, std::vector<unsigned char>& vchNextInfoHash)
+{
+    if (!pMutableDataDB)
         return false;
 
-    return true;
+    return pMutableDataDB->ListMutableData(vchStartInfoHash, nLimit, vchMutableData, vchNextInfoHash);
 }
 
 bool SelectRandomMutableItem(CMutableData& randomItem)
@@ -114,69 +141,132 @@ bool CheckMutableItemDB()
     return true;
 }
 
+size_t CInfoHashHasher::operator()(const uint160& hash) const
+{
+    return ReadLE64(hash.begin());
+}
+
 bool CMutableDataDB::AddMutableData(const CMutableData& data)
 {
     bool writeState = false;
     {
         LOCK(cs_dht_entry);
-        writeState = CDBWrapper::Write(make_pair(std::string("ih"), data.vchInfoHash), data);  // use info hash as key
-        if (count >= 0) {
-            mapDataStorage[data.vchInfoHash] = data;
-            count++;
-        }
+        writeState = CDBWrapper::Write(make_pair(DB_MUTABLE_KEY, data.vchInfoHash), data);  // use info hash as key
+        if (writeState)
+            AddIndexKey(data.vchInfoHash);
     }
     return writeState;
 }
 
 bool CMutableDataDB::ReadMutableData(const std::vector<unsigned char>& vchInfoHash, CMutableData& data)
 {
-    if (count >= 0) {
-        data = mapDataStorage[vchInfoHash];
-        if (!data.IsNull())
-            return true;
-    }
-
     LOCK(cs_dht_entry);
-    return CDBWrapper::Read(make_pair(std::string("ih"), vchInfoHash), data);
+    return CDBWrapper::Read(make_pair(DB_MUTABLE_KEY, vchInfoHash), data);
 }
 
 bool CMutableDataDB::EraseMutableData(const std::vector<unsigned char>& vchInfoHash)
 {
     LOCK(cs_dht_entry);
-    if (count >= 0)
-        mapDataStorage.erase(vchInfoHash);
-
-    return CDBWrapper::Erase(make_pair(std::string("ih"), vchInfoHash));
+    EraseIndexKey(vchInfoHash);
+    return CDBWrapper::Erase(make_pair(DB_MUTABLE_KEY, vchInfoHash));
 }
 
 bool CMutableDataDB::UpdateMutableData(const CMutableData& data)
 {
     LOCK(cs_dht_entry);
 
-    if (!EraseMutableData(data.vchInfoHash))
+    if (!CDBWrapper::Erase(make_pair(DB_MUTABLE_KEY, data.vchInfoHash)))
         return false;
 
     bool writeState = false;
-    writeState = CDBWrapper::Update(make_pair(std::string("ih"), data.vchInfoHash), data);
-    if (count >= 0)
-        mapDataStorage[data.vchInfoHash] = data;
+    writeState = CDBWrapper::Update(make_pair(DB_MUTABLE_KEY, data.vchInfoHash), data);
+    if (writeState)
+        AddIndexKey(data.vchInfoHash);
 
     return writeState;
 }
 
-bool CMutableDataDB::ListMutableData(std::vector<CMutableData>& vchMutableData)
+bool CMutableDataDB::PutMutableDataIfNewer(const std::vector<unsigned char>& vchInfoHash, const CMutableDataView& data, bool& fStored)
 {
+    fStored = false;
+    LOCK(cs_dht_entry);
+    CMutableDataSequence stored;
+    if (CDBWrapper::Read(make_pair(DB_MUTABLE_KEY, vchInfoHash), stored) && data.SequenceNumber <= stored.SequenceNumber)
+        return true;
+
+    if (!CDBWrapper::Write(make_pair(DB_MUTABLE_KEY, vchInfoHash), data))
+        return false;
+
+    AddIndexKey(vchInfoHash);
+    fStored = true;
+    return true;
+}
+
+bool CMutableDataDB::Upgrade()
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(make_pair(DB_MUTABLE_HEX_KEY, CharString()));
+    if (!pcursor->Valid())
+        return true;
+
+    LogPrintf("Upgrading DHT mutable data database...\n");
+    int64_t nStart = GetTimeMillis();
+    int64_t nUpgraded = 0;
+    int64_t nInvalid = 0;
+    size_t nBatchSize = 1 << 24;
+    CDBBatch batch(*this);
+    std::pair<std::string, CharString> key;
+    LOCK(cs_dht_entry);
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        if (!pcursor->GetKey(key) || key.first != DB_MUTABLE_HEX_KEY)
+            break;
+
+        // every record under the hex key prefix is converted, whatever its nVersion says
+        CMutableData data;
+        if (!pcursor->GetValue(data))
+            return error("%s: cannot parse mutable data record", __func__);
+
+        data.ConvertFromHex();
+        if (data.vchInfoHash.size() != 20) {
+            // kept under the hex key so nothing is lost, the upgrade retries it on the next start
+            LogPrintf("%s: keeping mutable data record %s, its info hash is not 20 bytes of hex\n", __func__, HexStr(key.second));
+            nInvalid++;
+            pcursor->Next();
+            continue;
+        }
+        batch.Write(make_pair(DB_MUTABLE_KEY, data.vchInfoHash), data);
+        batch.Erase(key);
+        nUpgraded++;
+        if (batch.SizeEstimate() > nBatchSize) {
+            WriteBatch(batch);
+            batch.Clear();
+        }
+        pcursor->Next();
+    }
+    if (!WriteBatch(batch, true))
+        return false;
+    CompactRange(make_pair(DB_MUTABLE_HEX_KEY, CharString()), key);
+    LogPrintf("Upgraded %d DHT mutable data records in %dms, %d invalid records kept\n", nUpgraded, GetTimeMillis() - nStart, nInvalid);
+    return true;
+}
+
+bool CMutableDataDB::ForEachMutableData(const std::function<bool(const CMutableData&)>& func)
+{
+    // Only one record is held in memory at a time
     std::pair<std::string, CharString> infoHash;
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
-    pcursor->SeekToFirst();
+    pcursor->Seek(make_pair(DB_MUTABLE_KEY, CharString()));
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
         CMutableData data;
         try {
-            if (pcursor->GetKey(infoHash) && infoHash.first == "ih") {
-                pcursor->GetValue(data);
-                vchMutableData.push_back(data);
-            }
+            if (!pcursor->GetKey(infoHash) || infoHash.first != DB_MUTABLE_KEY)
+                break;
+            if (!pcursor->GetValue(data))
+                return error("%s() : cannot read mutable data record", __PRETTY_FUNCTION__);
+            if (!func(data))
+                break;
             pcursor->Next();
         }
         catch (std::exception& e) {
@@ -186,22 +276,28 @@ bool CMutableDataDB::ListMutableData(std::vector<CMutableData>& vchMutableData)
     return true;
 }
 
-bool CMutableDataDB::LoadMemoryMap()
+bool CMutableDataDB::ListMutableData(const std::vector<unsigned char>& vchStartInfoHash, size_t nLimit,
+                                     std::vector<CMutableData>& vchMutableData, std::vector<unsigned char>& vchNextInfoHash)
 {
     std::pair<std::string, CharString> infoHash;
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
-    pcursor->SeekToFirst();
-    count = 0;
+    pcursor->Seek(make_pair(DB_MUTABLE_KEY, vchStartInfoHash));
+    // cleared only after the seek, callers may pass the same vector as start and next key
+    vchNextInfoHash.clear();
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
         CMutableData data;
         try {
-            if (pcursor->GetKey(infoHash) && infoHash.first == "ih") {
-                pcursor->GetValue(data);
-                mapDataStorage[infoHash.second] = data;
+            if (!pcursor->GetKey(infoHash) || infoHash.first != DB_MUTABLE_KEY)
+                break;
+            if (nLimit > 0 && vchMutableData.size() >= nLimit) {
+                vchNextInfoHash = infoHash.second;
+                break;
             }
+            if (!pcursor->GetValue(data))
+                return error("%s() : cannot read mutable data record", __PRETTY_FUNCTION__);
+            vchMutableData.push_back(data);
             pcursor->Next();
-            count++;
         }
         catch (std::exception& e) {
             return error("%s() : deserialize error", __PRETTY_FUNCTION__);
@@ -210,16 +306,104 @@ bool CMutableDataDB::LoadMemoryMap()
     return true;
 }
 
-bool CMutableDataDB::SelectRandomMutableItem(CMutableData& randomItem) {
-    if (count < 1)
-        return false;
+bool CMutableDataDB::ListMutableData(std::vector<CMutableData>& vchMutableData)
+{
+    std::vector<unsigned char> vchNextInfoHash;
+    return ListMutableData(std::vector<unsigned char>(), 0, vchMutableData, vchNextInfoHash);
+}
 
-    unsigned int nAdvance = 0;
-    std::map<std::vector<unsigned char>, CMutableData>::iterator it = mapDataStorage.begin();
-    if (count != 1) {
-        nAdvance = RandomIntegerRange(0, count - 1);
+bool CMutableDataDB::ListMutableDataKeys(std::vector<std::vector<unsigned char>>& vvchInfoHashes)
+{
+    // Only keys are decoded, so this stays cheap however large the values are
+    std::pair<std::string, CharString> infoHash;
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(make_pair(DB_MUTABLE_KEY, CharString()));
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        try {
+            if (!pcursor->GetKey(infoHash) || infoHash.first != DB_MUTABLE_KEY)
+                break;
+            vvchInfoHashes.push_back(infoHash.second);
+            pcursor->Next();
+        }
+        catch (std::exception& e) {
+            return error("%s() : deserialize error", __PRETTY_FUNCTION__);
+        }
     }
-    std::advance(it, nAdvance);
-    randomItem = it->second;
     return true;
-}
\ No newline at end of file
+}
+
+bool CMutableDataDB::LoadKeyIndex()
+{
+    AssertLockHeld(cs_dht_entry);
+    if (fKeyIndexLoaded)
+        return true;
+
+    std::vector<std::vector<unsigned char>> vvchInfoHashes;
+    if (!ListMutableDataKeys(vvchInfoHashes))
+        return false;
+
+    vIndexKeys.clear();
+    mapIndexPositions.clear();
+    fKeyIndexLoaded = true;
+    vIndexKeys.reserve(vvchInfoHashes.size());
+    mapIndexPositions.reserve(vvchInfoHashes.size());
+    for (const std::vector<unsigned char>& vchInfoHash : vvchInfoHashes)
+        AddIndexKey(vchInfoHash);
+
+    LogPrint("dht", "%s -- Loaded %u mutable data keys\n", __func__, vIndexKeys.size());
+    return true;
+}
+
+void CMutableDataDB::AddIndexKey(const std::vector<unsigned char>& vchInfoHash)
+{
+    if (!fKeyIndexLoaded || vchInfoHash.size() != 20)
+        return;
+
+    uint160 key(vchInfoHash);
+    if (mapIndexPositions.emplace(key, vIndexKeys.size()).second)
+        vIndexKeys.push_back(key);
+}
+
+void CMutableDataDB::EraseIndexKey(const std::vector<unsigned char>& vchInfoHash)
+{
+    if (!fKeyIndexLoaded || vchInfoHash.size() != 20)
+        return;
+
+    auto it = mapIndexPositions.find(uint160(vchInfoHash));
+    if (it == mapIndexPositions.end())
+        return;
+
+    // move the last key into the freed slot so removal stays constant time
+    const size_t nPos = it->second;
+    mapIndexPositions.erase(it);
+    if (nPos != vIndexKeys.size() - 1) {
+        vIndexKeys[nPos] = vIndexKeys.back();
+        mapIndexPositions[vIndexKeys[nPos]] = nPos;
+    }
+    vIndexKeys.pop_back();
+}
+
+int64_t CMutableDataDB::Size() const
+{
+    LOCK(cs_dht_entry);
+    return fKeyIndexLoaded ? (int64_t)vIndexKeys.size() : -1;
+}
+
+bool CMutableDataDB::SelectRandomMutableItem(CMutableData& randomItem)
+{
+    LOCK(cs_dht_entry);
+    if (!LoadKeyIndex())
+        return false;
+
+    // skip keys whose records have gone missing, dropping them from the index
+    while (!vIndexKeys.empty()) {
+        const size_t nPos = GetRandInt(vIndexKeys.size());
+        const uint160& key = vIndexKeys[nPos];
+        std::vector<unsigned char> vchInfoHash(key.begin(), key.end());
+        if (CDBWrapper::Read(make_pair(DB_MUTABLE_KEY, vchInfoHash), randomItem))
+            return true;
+        EraseIndexKey(vchInfoHash);
+    }
+    return false;
+}
@@ -7,10 +7,19 @@
 
 #include "dbwrapper.h"
 #include "sync.h"
+#include "uint256.h"
+
+#include <functional>
+#include <unordered_map>
 
 static CCriticalSection cs_dht_entry;
 
 class CMutableData;
+class CMutableDataView;
+
+struct CInfoHashHasher {
+    size_t operator()(const uint160& hash) const;
+};
 
 class CMutableDataDB : public CDBWrapper {
 public:
@@ -19,24 +28,50 @@ public:
 
     bool AddMutableData(const CMutableData& data);
     bool UpdateMutableData(const CMutableData& data);
+    /**
+     * Write data when its sequence number is greater than the stored record's, or there is none.
+     * Costs one read of the stored sequence number and one write. fStored tells whether it was written.
+     */
+    bool PutMutableDataIfNewer(const std::vector<unsigned char>& vchInfoHash, const CMutableDataView& data, bool& fStored);
     bool ReadMutableData(const std::vector<unsigned char>& vchInfoHash, CMutableData& data);
     bool EraseMutableData(const std::vector<unsigned char>& vchInfoHash);
+    /** Stream every record through func without loading the table, stops early when func returns false */
+    bool ForEachMutableData(const std::function<bool(const CMutableData&)>& func);
+    /**
+     * Read at most nLimit records starting at vchStartInfoHash (inclusive). vchNextInfoHash is set to the
+     * key the following page starts at, or left empty when the end of the table was reached.
+     */
+    bool ListMutableData(const std::vector<unsigned char>& vchStartInfoHash, size_t nLimit,
+                         std::vector<CMutableData>& vchMutableData, std::vector<unsigned char>& vchNextInfoHash);
     bool ListMutableData(std::vector<CMutableData>& vchMutableData);
-    bool LoadMemoryMap();
+    bool ListMutableDataKeys(std::vector<std::vector<unsigned char>>& vvchInfoHashes);
+    /** Rewrite version 1 hex records under raw info hash keys */
+    bool Upgrade();
     bool SelectRandomMutableItem(CMutableData& randomItem);
-    int64_t Size() const { return count; }
+    /** Number of stored records, -1 until the key index has been loaded */
+    int64_t Size() const;
 
 private:
-	int64_t count = -1;
+    // Key only index used for random selection, loaded on first use and kept in step with writes after that
+    bool fKeyIndexLoaded = false;
+    std::vector<uint160> vIndexKeys;
+    std::unordered_map<uint160, size_t, CInfoHashHasher> mapIndexPositions;
 
+    bool LoadKeyIndex();
+    void AddIndexKey(const std::vector<unsigned char>& vchInfoHash);
+    void EraseIndexKey(const std::vector<unsigned char>& vchInfoHash);
 };
 
 bool AddLocalMutableData(const std::vector<unsigned char>& vchInfoHash, const CMutableData& data);
 bool UpdateLocalMutableData(const std::vector<unsigned char>& vchInfoHash, const CMutableData& data);
 bool GetLocalMutableData(const std::vector<unsigned char>& vchInfoHash, CMutableData& data);
 bool PutLocalMutableData(const std::vector<unsigned char>& vchInfoHash, const CMutableData& data);
+bool PutLocalMutableDataIfNewer(const std::vector<unsigned char>& vchInfoHash, const CMutableDataView& data, bool& fStored);
 bool GetAllLocalMutableData(std::vector<CMutableData>& vchMutableData);
-bool InitMemoryMap();
+bool GetAllLocalMutableDataKeys(std::vector<std::vector<unsigned char>>& vvchInfoHashes);
+bool ForEachLocalMutableData(const std::function<bool(const CMutableData&)>& func);
+bool GetLocalMutableDataPage(const std::vector<unsigned char>& vchStartInfoHash, size_t nLimit,
+                             std::vector<CMutableData>& vchMutableData, std::vector<unsigned char>& vchNextInfoHash);
 bool SelectRandomMutableItem(CMutableData& randomItem);
 bool CheckMutableItemDB();
 
@@ -11,9 +11,11 @@
 #include "dht/sessionevents.h"
 #include "dht/datachunk.h"
 #include "dht/dataheader.h"
+#include "dht/ed25519.h"
 #include "dht/mutable.h"
 #include "dht/mutabledb.h"
 #include "dht/settings.h"
+#include "dht/storage.h"
 #include "dynode-sync.h"
 #include "net.h"
 #include "spork.h"
@@ -36,6 +38,7 @@
 #include <cstdio> // for snprintf
 #include <cinttypes> // for PRId64 et.al.
 #include <cstdlib>
+#include <limits>
 #include <functional>
 #include <fstream>
 #include <thread>
@@ -43,7 +46,6 @@
 using namespace libtorrent;
 
 static constexpr size_t nThreads = 8;
-static constexpr int64_t nReannouceSleepMilliSleep = (60 * 1000); // re-announce one item every minute.
 
 bool fMultiThreads;
 
@@ -54,8 +56,8 @@ static SessionThreadGroup arraySessions;
 static std::shared_ptr<std::thread> pDHTTorrentThread;
 static std::shared_ptr<boost::thread> pReannounceThread = nullptr;
 static std::map<HashRecordKey, uint32_t> mPutCommands;
-//             <InfoHash   ,      pair<seq    , epoch>
-static std::map<std::string, std::pair<int64_t, int64_t>> mReannouceInfoHashes;
+static CCriticalSection cs_reannounce;
+static CReannounceStats reannounceStats;
 static uint64_t nPutRecords = 0;
 static uint64_t nPutPieces = 0;
 static uint64_t nPutBytes = 0;
@@ -145,20 +147,51 @@ void CHashTableSession::StopEventListener()
 bool CHashTableSession::ReannounceEntry(const CMutableData& mutableData)
 {
     libtorrent::entry mut_item;
+    if (mutableData.vchPublicKey.size() != ED25519_PUBLIC_KEY_BYTE_LENGTH || mutableData.vchSignature.size() != ED25519_SIGTATURE_BYTE_LENGTH)
+        return false;
+
     if (mutableData.vchSalt.size() > 0 && ConvertMutableEntryValue(mutableData, mut_item)) {
-        libtorrent::sha1_hash infohash(mutableData.InfoHash().c_str());
+        const std::string infohash = mutableData.InfoHash();
         std::array<char, ED25519_PUBLIC_KEY_BYTE_LENGTH> pubkey;
-        aux::from_hex(mutableData.PublicKey(), pubkey.data());
+        std::copy(mutableData.vchPublicKey.begin(), mutableData.vchPublicKey.end(), pubkey.begin());
         std::array<char, ED25519_SIGTATURE_BYTE_LENGTH> signature_bytes;
-        aux::from_hex(mutableData.Signature(), signature_bytes.data());
+        std::copy(mutableData.vchSignature.begin(), mutableData.vchSignature.end(), signature_bytes.begin());
         Session->dht_put_item(pubkey, std::bind(&DHT::put_signed_bytes, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, 
              pubkey, signature_bytes, mut_item, mutableData.SequenceNumber), mutableData.Salt());
-        LogPrint("dht", "%s -- Re-annoucing item infohash %s, entry \n%s\n", __func__, infohash.to_string(), mut_item.to_string());
+        pendingPuts.Add();
+        LogPrint("dht", "%s -- Re-annoucing item infohash %s, entry \n%s\n", __func__, infohash, mut_item.to_string());
         return true;
     }
     return false;
 }
 
+void CPendingRequests::Add()
+{
+    LOCK(cs_pending);
+    vSubmitTimes.push_back(GetTimeMillis());
+}
+
+void CPendingRequests::Remove()
+{
+    LOCK(cs_pending);
+    if (!vSubmitTimes.empty())
+        vSubmitTimes.pop_front();
+}
+
+void CPendingRequests::Expire(const int64_t nTimeout)
+{
+    const int64_t nExpireTime = GetTimeMillis() - nTimeout;
+    LOCK(cs_pending);
+    while (!vSubmitTimes.empty() && vSubmitTimes.front() < nExpireTime)
+        vSubmitTimes.pop_front();
+}
+
+int CPendingRequests::Count() const
+{
+    LOCK(cs_pending);
+    return (int)vSubmitTimes.size();
+}
+
 void StartEventListener(std::shared_ptr<CHashTableSession> dhtSession)
 {
     if (!dhtSession) {
@@ -190,11 +223,17 @@ void StartEventListener(std::shared_ptr<CHashTableSession> dhtSession)
             const int iAlertType = (*iAlert)->type();
             const std::string strAlertTypeName = alert_name(iAlertType);
             if (iAlertType == DHT_GET_ALERT_TYPE_CODE || iAlertType == DHT_PUT_ALERT_TYPE_CODE) {
+                if (iAlertType == DHT_PUT_ALERT_TYPE_CODE) {
+                    dhtSession->pendingPuts.Remove();
+                }
                 if (iAlertType == DHT_GET_ALERT_TYPE_CODE) {
                     // DHT Get Mutable Event
                     dht_mutable_item_alert* pGet = alert_cast<dht_mutable_item_alert>((*iAlert));
                     if (pGet == nullptr)
                         continue;
+                    // every lookup ends with one authoritative alert
+                    if (pGet->authoritative)
+                        dhtSession->pendingGets.Remove();
                     LogPrint("dht", "%s -- PubKey = %s, Salt = %s, Value = %s\nMessage = %s, Alert Type =%s, Alert Category = %u\n"
                         , __func__, aux::to_hex(pGet->key), pGet->salt, pGet->item.to_string(), strAlertMessage, strAlertTypeName, iAlertCategory);
 
@@ -204,6 +243,15 @@ void StartEventListener(std::shared_ptr<CHashTableSession> dhtSession)
 
                         std::string infoHash = GetInfoHash(event.PublicKey(), event.Salt());
                         dhtSession->AddToDHTGetEventMap(infoHash, event);
+                        // a node can return an old sequence number before the lookup ends
+                        if (pGet->authoritative)
+                            dhtSession->CompleteDHTGetRequest(infoHash, event);
+                        else
+                            dhtSession->UpdateDHTGetRequest(infoHash, event);
+                    }
+                    else if (pGet->authoritative) {
+                        // the lookup finished without another value
+                        dhtSession->CompleteDHTGetRequest(GetInfoHash(aux::to_hex(pGet->key), pGet->salt), CMutableGetEvent());
                     }
                 }
             } else if (iAlertType == DHT_STATS_ALERT_TYPE_CODE) {
@@ -222,10 +270,13 @@ void StartEventListener(std::shared_ptr<CHashTableSession> dhtSession)
         if (dhtSession->fShutdown)
             return;
 
+        dhtSession->pendingGets.Expire(DHT_PENDING_REQUEST_EXPIRE_MILLISECONDS);
+        dhtSession->pendingPuts.Expire(DHT_PENDING_REQUEST_EXPIRE_MILLISECONDS);
         counter++;
         if (counter % 60 == 0) {
             LogPrint("dht", "DHTEventListener -- Before CleanUpEventMap. counter = %u\n", counter);
             dhtSession->CleanUpEventMap(300000);
+            dhtSession->CleanUpDHTGetRequests(DHT_GET_REQUEST_EXPIRE_MILLISECONDS);
         }
     }
 }
@@ -250,59 +301,100 @@ bool ConvertMutableEntryValue(const CMutableData& local_mut_data, libtorrent::en
     return true;
 }
 
+// Libtorrent does not report how many nodes returned an item, so an item counts as replicated
+// when a lookup from the session that reannounces it finds the local sequence number or a newer one.
+static bool IsItemReplicated(const CMutableData& mutableData)
+{
+    const std::shared_ptr<CHashTableSession>& pSession = arraySessions[DHT::GetReannounceSession(mutableData.vchInfoHash)].second;
+    if (!pSession || mutableData.vchPublicKey.size() != ED25519_PUBLIC_KEY_BYTE_LENGTH)
+        return false;
+
+    std::array<char, ED25519_PUBLIC_KEY_BYTE_LENGTH> pubkey;
+    std::copy(mutableData.vchPublicKey.begin(), mutableData.vchPublicKey.end(), pubkey.begin());
+    CMutableGetEvent event;
+    if (!pSession->SubmitGetAsync(pubkey, mutableData.Salt())->Wait(GetTimeMillis() + DHT_GET_TIMEOUT_MILLISECONDS, event))
+        return false;
+
+    return event.SequenceNumber() >= mutableData.SequenceNumber;
+}
+
 void ReannounceEntries()
 {
-    if (InitMemoryMap()) {
-        try {
-            while (fReannounceStarted) {
-                // cleanup mReannouceInfoHashes map, make sure it doesn't get too big.
-                MilliSleep(nReannouceSleepMilliSleep);
-                boost::this_thread::interruption_point();
-                CMutableData randomMutableItem;
-                // select one local item at random.  
-                if (SelectRandomMutableItem(randomMutableItem)) {
-                    // Check if already re-annouced item
-                    int64_t nCurrentTime = GetTime();
-                    std::map<std::string, std::pair<int64_t, int64_t>>::iterator it = mReannouceInfoHashes.find(randomMutableItem.InfoHash());
-                    if (it == mReannouceInfoHashes.end()) {
-                        mReannouceInfoHashes[randomMutableItem.InfoHash()] = std::make_pair(randomMutableItem.SequenceNumber, nCurrentTime);
-                    } else {
-                        // check if we have a higher sequence number
-                        if (randomMutableItem.SequenceNumber > it->second.first) {
-                            mReannouceInfoHashes[randomMutableItem.InfoHash()] = std::make_pair(randomMutableItem.SequenceNumber, nCurrentTime);
-                        // check if we re-annouced over an hour ago
-                        } else if (nCurrentTime - it->second.second > (60 * 60)) {
-                            mReannouceInfoHashes[randomMutableItem.InfoHash()] = std::make_pair(randomMutableItem.SequenceNumber, nCurrentTime);
-                        } else {
-                            // already re-annouced entry within the hour with the same sequence number.  Do not re-annouce entry.
-                            continue;
-                        }
+    try {
+        while (fReannounceStarted) {
+            // Each round walks every local item once, at most nRate items per minute
+            const int64_t nRate = std::max(GetArg("-dhtreannouncerate", DEFAULT_DHT_REANNOUNCE_RATE), (int64_t)1);
+            const int64_t nRoundStart = GetTime();
+            std::vector<std::vector<unsigned char>> vvchInfoHashes;
+            if (!GetAllLocalMutableDataKeys(vvchInfoHashes))
+                LogPrintf("%s -- GetAllLocalMutableDataKeys failed.\n", __func__);
+
+            uint64_t nRound;
+            {
+                LOCK(cs_reannounce);
+                nRound = ++reannounceStats.nRound;
+                reannounceStats.nRoundStart = nRoundStart;
+                reannounceStats.nRoundItems = vvchInfoHashes.size();
+                reannounceStats.nRoundChecked = 0;
+                reannounceStats.nRoundReplicated = 0;
+                reannounceStats.nRoundReannounced = 0;
+            }
+            for (size_t nBatchStart = 0; nBatchStart < vvchInfoHashes.size(); nBatchStart += DHT_REANNOUNCE_VERIFY_BATCH) {
+                // Verify a batch of stored signatures up front so corrupt records are never announced
+                const size_t nBatchEnd = std::min(nBatchStart + DHT_REANNOUNCE_VERIFY_BATCH, vvchInfoHashes.size());
+                std::vector<CMutableData> vItems;
+                std::vector<CEd25519SignatureCheck> vChecks;
+                for (size_t i = nBatchStart; i < nBatchEnd; i++) {
+                    CMutableData mutableItem;
+                    if (!GetLocalMutableData(vvchInfoHashes[i], mutableItem) || mutableItem.vchSalt.size() == 0)
+                        continue;
+                    vChecks.emplace_back(mutableItem.vchPublicKey, mutableItem.vchSignature,
+                                         MutableItemSignedBytes(mutableItem.vchValue, mutableItem.SequenceNumber, mutableItem.vchSalt));
+                    vItems.push_back(mutableItem);
+                }
+                std::vector<bool> vValid;
+                Ed25519VerifyBatch(vChecks, vValid);
+
+                for (size_t i = 0; i < vItems.size(); i++) {
+                    const CMutableData& mutableItem = vItems[i];
+                    if (!vValid[i]) {
+                        LogPrintf("%s -- Skipping item %s with an invalid signature.\n", __func__, mutableItem.InfoHash());
+                        LOCK(cs_reannounce);
+                        reannounceStats.nRoundChecked++;
+                        reannounceStats.nTotalInvalid++;
+                        continue;
                     }
-                    // TODO (DHT): Check if fewer than 8 nodes returned the item with the most recent sequence number before re-announcing item
-                    if (randomMutableItem.vchSalt.size() > 0) {
-                        arraySessions[0].second->ReannounceEntry(randomMutableItem);
+                    MilliSleep(60 * 1000 / nRate);
+                    if (!fReannounceStarted)
+                        return;
+
+                    bool fReplicated = IsItemReplicated(mutableItem);
+                    bool fReannounced = !fReplicated && DHT::ReannounceEntry(mutableItem);
+                    LOCK(cs_reannounce);
+                    reannounceStats.nRoundChecked++;
+                    if (fReplicated)
+                        reannounceStats.nRoundReplicated++;
+                    if (fReannounced) {
+                        reannounceStats.nRoundReannounced++;
+                        reannounceStats.nTotalReannounced++;
                     }
                 }
             }
-        } catch (const boost::thread_interrupted& ex) {
-            LogPrintf("%s -- thread_interrupted\n", __func__);
-        } catch (const std::exception& ex) {
-            LogPrintf("%s -- ex %s\n", __func__, ex.what());
+            {
+                LOCK(cs_reannounce);
+                reannounceStats.nLastRoundSeconds = GetTime() - nRoundStart;
+            }
+            LogPrint("dht", "%s -- round %d checked %d items in %d seconds\n", __func__, nRound, vvchInfoHashes.size(), GetTime() - nRoundStart);
+            // Do not start the next round until DHT_REANNOUNCE_ROUND_SECONDS after this one started
+            while (fReannounceStarted && GetTime() - nRoundStart < DHT_REANNOUNCE_ROUND_SECONDS) {
+                MilliSleep(1000);
+            }
         }
+    } catch (const boost::thread_interrupted& ex) {
+        LogPrintf("%s -- thread_interrupted\n", __func__);
+    } catch (const std::exception& ex) {
+        LogPrintf("%s -- ex %s\n", __func__, ex.what());
     }
-    else {
-        LogPrintf("%s -- InitMemoryMap failed.\n", __func__);
-    }
-    /*
-    1. pick one random item (i) from the local repository (except
-       items already announced this round)
-    2. If all items in the local repository have been announced
-      2.1 terminate
-    3. look up item i in the DHT
-    4. If fewer than 8 nodes returned the item
-      4.1 announce i to the DHT
-      4.2 goto 1
-    */
 }
 
 bool CHashTableSession::Bootstrap()
@@ -544,6 +636,7 @@ bool CHashTableSession::SubmitPut(const std::array<char, 32> public_key, const s
 {
     Session->dht_put_item(public_key, std::bind(&DHT::put_mutable_bytes, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, 
                           public_key, private_key, entryValue, lastSequence), strSalt);
+    pendingPuts.Add();
     return true;
 }
 
@@ -558,40 +651,131 @@ bool CHashTableSession::SubmitGet(const std::array<char, 32>& public_key, const
         return false;
     }
     Session->dht_get_item(public_key, recordSalt);
+    pendingGets.Add();
     LogPrint("dht", "CHashTableSession::%s -- pubkey = %s, salt = %s\n", __func__, aux::to_hex(public_key), recordSalt);
 
     return true;
 }
 
-bool CHashTableSession::SubmitGet(const std::array<char, 32>& public_key, const std::string& recordSalt, const int64_t& timeout, 
-                            std::string& recordValue, int64_t& lastSequence, bool& fAuthoritative)
+// Strips the quotes libtorrent adds around string entries
+static std::string GetEventValue(const CMutableGetEvent& event)
 {
-    std::string infoHash = GetInfoHash(aux::to_hex(public_key),recordSalt);
-    RemoveDHTGetEvent(infoHash);
-    if (!SubmitGet(public_key, recordSalt))
-        return false;
-    MilliSleep(40);
-    CMutableGetEvent data;
-    int64_t startTime = GetTimeMillis();
-    while (timeout > GetTimeMillis() - startTime)
+    std::string strData = event.Value();
+    // TODO (DHT): check the last position for the single quote character
+    if (strData.substr(0, 1) == "'")
+        return strData.substr(1, strData.size() - 2);
+
+    return strData;
+}
+
+MutableGetRequestRef CHashTableSession::SubmitGetAsync(const std::array<char, 32>& public_key, const std::string& recordSalt)
+{
+    const std::string infoHash = GetInfoHash(aux::to_hex(public_key), recordSalt);
+    MutableGetRequestRef request;
     {
-        if (FindDHTGetEvent(infoHash, data)) {
-            std::string strData = data.Value();
-            // TODO (DHT): check the last position for the single quote character
-            if (strData.substr(0, 1) == "'") {
-                recordValue = strData.substr(1, strData.size() - 2);
-            }
-            else {
-                recordValue = strData;
-            }
-            lastSequence = data.SequenceNumber();
-            fAuthoritative = data.Authoritative();
-            LogPrint("dht", "CHashTableSession::%s -- salt = %s, value = %s, seq = %d, auth = %u\n", __func__, recordSalt, recordValue, lastSequence, fAuthoritative);
-            return true;
+        LOCK(cs_DHTGetEventMap);
+        DHTGetRequestMap::iterator it = m_DHTGetRequests.find(infoHash);
+        if (it != m_DHTGetRequests.end()) {
+            if (GetTimeMillis() - it->second->nSubmitTime < DHT_GET_TIMEOUT_MILLISECONDS)
+                return it->second;
+            // The lookup is overdue, look again but keep the request so its waiters are completed by either lookup
+            it->second->nSubmitTime = GetTimeMillis();
+            request = it->second;
+        }
+        else {
+            m_DHTGetEventMap.erase(infoHash);
+            request = std::make_shared<CMutableGetRequest>(GetTimeMillis());
+            m_DHTGetRequests[infoHash] = request;
         }
-        MilliSleep(10);
     }
-    return false;
+    if (!SubmitGet(public_key, recordSalt))
+        CompleteDHTGetRequest(infoHash, CMutableGetEvent());
+
+    return request;
+}
+
+void CHashTableSession::UpdateDHTGetRequest(const std::string& infoHash, const CMutableGetEvent& event)
+{
+    LOCK(cs_DHTGetEventMap);
+    DHTGetRequestMap::iterator it = m_DHTGetRequests.find(infoHash);
+    if (it != m_DHTGetRequests.end())
+        it->second->Update(event);
+}
+
+void CHashTableSession::CompleteDHTGetRequest(const std::string& infoHash, const CMutableGetEvent& event)
+{
+    LOCK(cs_DHTGetEventMap);
+    DHTGetRequestMap::iterator it = m_DHTGetRequests.find(infoHash);
+    if (it == m_DHTGetRequests.end())
+        return;
+
+    it->second->Complete(event);
+    m_DHTGetRequests.erase(it);
+}
+
+void CHashTableSession::CleanUpDHTGetRequests(const int64_t timeout)
+{
+    // Expired requests complete with the newest value found, so anyone still waiting returns
+    const int64_t nTime = GetTimeMillis();
+    LOCK(cs_DHTGetEventMap);
+    for (DHTGetRequestMap::iterator it = m_DHTGetRequests.begin(); it != m_DHTGetRequests.end(); ) {
+        if (nTime - it->second->nSubmitTime > timeout) {
+            it->second->Complete(CMutableGetEvent());
+            it = m_DHTGetRequests.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+std::vector<MutableGetRequestRef> CHashTableSession::SubmitGetChunksAsync(const std::array<char, 32>& public_key, const std::string& strOperationType, const CRecordHeader& header)
+{
+    // Spread the chunks over the least loaded sessions in the thread group
+    std::vector<MutableGetRequestRef> vRequests;
+    vRequests.reserve(header.nChunks);
+    for (unsigned int i = 0; i < header.nChunks; i++) {
+        CHashTableSession* pSession = arraySessions[DHT::SelectSession()].second.get();
+        if (!pSession || !pSession->Session)
+            pSession = this;
+        vRequests.push_back(pSession->SubmitGetAsync(public_key, strOperationType + ":" + std::to_string(i + 1)));
+    }
+    return vRequests;
+}
+
+bool CHashTableSession::WaitForChunks(const std::vector<MutableGetRequestRef>& vRequests, const std::string& strOperationType, const int64_t nSequence, const int64_t nDeadline, std::vector<CDataChunk>& vChunks)
+{
+    vChunks.clear();
+    vChunks.reserve(vRequests.size());
+    for (unsigned int i = 0; i < vRequests.size(); i++) {
+        std::string strChunkSalt = strOperationType + ":" + std::to_string(i + 1);
+        CMutableGetEvent event;
+        if (!vRequests[i]->Wait(nDeadline, event)) {
+            LogPrint("dht", "CHashTableSession::%s -- chunk salt = %s not found\n", __func__, strChunkSalt);
+            return false;
+        }
+        if (event.SequenceNumber() != nSequence) {
+            // the record was updated between reading its header and this chunk
+            LogPrint("dht", "CHashTableSession::%s -- chunk salt = %s seq = %d, header seq = %d\n", __func__, strChunkSalt, event.SequenceNumber(), nSequence);
+            return false;
+        }
+        vChunks.push_back(CDataChunk(i, i + 1, strChunkSalt, GetEventValue(event)));
+    }
+    return true;
+}
+
+bool CHashTableSession::SubmitGet(const std::array<char, 32>& public_key, const std::string& recordSalt, const int64_t& timeout, 
+                            std::string& recordValue, int64_t& lastSequence, bool& fAuthoritative)
+{
+    CMutableGetEvent data;
+    if (!SubmitGetAsync(public_key, recordSalt)->Wait(GetTimeMillis() + timeout, data))
+        return false;
+
+    recordValue = GetEventValue(data);
+    lastSequence = data.SequenceNumber();
+    fAuthoritative = data.Authoritative();
+    LogPrint("dht", "CHashTableSession::%s -- salt = %s, value = %s, seq = %d, auth = %u\n", __func__, recordSalt, recordValue, lastSequence, fAuthoritative);
+    return true;
 }
 
 static std::vector<unsigned char> Array32ToVector(const std::array<char, 32>& key32)
@@ -630,20 +814,16 @@ bool CHashTableSession::SubmitGetRecord(const std::array<char, 32>& public_key,
         return false; // Header failed, so don't try to get the rest of the record.
 
     header.LoadHex(strHeaderHex);
-    if (!header.IsNull() && header.nChunks > 0) {
+    if (!header.IsNull() && header.nChunks > 0 && header.nChunks <= nTotalSlots) {
+        // All chunks are requested at once, so a record takes about one round trip after its header
         std::vector<CDataChunk> vChunks;
-        for(unsigned int i = 0; i < header.nChunks; i++) {
-            std::string strChunkSalt = strOperationType + ":" + std::to_string(i+1);
-            std::string strChunk;
-            if (!SubmitGet(public_key, strChunkSalt, 2000, strChunk, iSequence, fAuthoritative)) {
-                strErrorMessage = "Failed to get record chunk.";
-                return false;
-            }
-            CDataChunk chunk(i, i + 1, strChunkSalt, strChunk);
-            vChunks.push_back(chunk);
+        const int64_t nDeadline = GetTimeMillis() + DHT_GET_TIMEOUT_MILLISECONDS;
+        if (!WaitForChunks(SubmitGetChunksAsync(public_key, strOperationType, header), strOperationType, iSequence, nDeadline, vChunks)) {
+            strErrorMessage = "Failed to get record chunk.";
+            return false;
         }
         CDataRecord getRecord(strOperationType, nTotalSlots, header, vChunks, Array32ToVector(private_seed));
-        if (record.HasError()) {
+        if (getRecord.HasError()) {
             strErrorMessage = strprintf("Record has errors: %s\n", __func__, getRecord.ErrorMessage());
             nGetErrors++;
             return false;
@@ -656,16 +836,6 @@ bool CHashTableSession::SubmitGetRecord(const std::array<char, 32>& public_key,
     return false;
 }
 
-bool CHashTableSession::GetDataFromMap(const std::array<char, 32>& public_key, const std::string& recordSalt, CMutableGetEvent& event)
-{
-    std::string infoHash = GetInfoHash(aux::to_hex(public_key), recordSalt);
-    if (FindDHTGetEvent(infoHash, event)) {
-        LogPrint("dht", "CHashTableSession::%s -- pubkey = %s, salt = %s, value = %s, seq = %d, auth = %u\n", __func__, event.PublicKey(), event.Salt(), event.Value(), event.SequenceNumber(), event.Authoritative());
-        return true;
-    }
-    return false;
-}
-
 bool CHashTableSession::SubmitGetAllRecordsSync(const std::vector<CLinkInfo>& vchLinkInfo, const std::string& strOperationType, std::vector<CDataRecord>& vchRecords)
 {
     std::vector<std::pair<CLinkInfo, std::string>> headerValues;
@@ -695,96 +865,47 @@ bool CHashTableSession::SubmitGetAllRecordsAsync(const std::vector<CLinkInfo>& v
 {
     uint16_t nTotalSlots = 32;
     strErrorMessage = "";
-    // Get the headers first
+    const std::string strHeaderSalt = strOperationType + ":" + std::to_string(0);
+    // Get all the headers at once
+    std::vector<MutableGetRequestRef> vHeaderRequests;
     for (const CLinkInfo& linkInfo : vchLinkInfo) {
-        std::string strHeaderHex;
-        std::string strHeaderSalt = strOperationType + ":" + std::to_string(0);
-        SubmitGet(EncodedVectorCharToArray32(linkInfo.vchSenderPubKey), strHeaderSalt);
-        MilliSleep(10);
+        vHeaderRequests.push_back(SubmitGetAsync(EncodedVectorCharToArray32(linkInfo.vchSenderPubKey), strHeaderSalt));
     }
 
-    MilliSleep(300); // Wait for headers data
-    std::vector<std::pair<CLinkInfo, CMutableGetEvent>> eventHeaders;
-    for (const CLinkInfo& linkInfo : vchLinkInfo) {
-        std::string strHeaderSalt = strOperationType + ":" + std::to_string(0);
-        const std::array<char, 32>& public_key = EncodedVectorCharToArray32(linkInfo.vchSenderPubKey);
-        CMutableGetEvent mutableGetData;
-        if (GetDataFromMap(public_key, strHeaderSalt, mutableGetData))
-        {
-            eventHeaders.push_back(std::make_pair(linkInfo, mutableGetData));
-        }
+    // Request each record's chunks as soon as its header arrives
+    std::vector<std::pair<size_t, CMutableGetEvent>> vHeaders;
+    std::vector<std::vector<MutableGetRequestRef>> vChunkRequests;
+    const int64_t nHeaderDeadline = GetTimeMillis() + DHT_GET_TIMEOUT_MILLISECONDS;
+    for (size_t i = 0; i < vchLinkInfo.size(); i++) {
+        CMutableGetEvent headerEvent;
+        if (!vHeaderRequests[i]->Wait(nHeaderDeadline, headerEvent))
+            continue;
+
+        CRecordHeader header(GetEventValue(headerEvent));
+        if (header.IsNull() || nTotalSlots < header.nChunks)
+            continue;
+
+        vChunkRequests.push_back(SubmitGetChunksAsync(EncodedVectorCharToArray32(vchLinkInfo[i].vchSenderPubKey), strOperationType, header));
+        vHeaders.push_back(std::make_pair(i, headerEvent));
     }
-    for (const std::pair<CLinkInfo, CMutableGetEvent>& eventHeader: eventHeaders)
-    {
-        std::string strHeaderHex = eventHeader.second.Value();
-        if (strHeaderHex.substr(0, 1) == "'") {
-            strHeaderHex = strHeaderHex.substr(1, strHeaderHex.size() - 2);
+
+    const int64_t nChunkDeadline = GetTimeMillis() + DHT_GET_TIMEOUT_MILLISECONDS;
+    for (size_t n = 0; n < vHeaders.size(); n++) {
+        const CLinkInfo& linkInfo = vchLinkInfo[vHeaders[n].first];
+        const CMutableGetEvent& headerEvent = vHeaders[n].second;
+        std::vector<CDataChunk> vChunks;
+        if (!WaitForChunks(vChunkRequests[n], strOperationType, headerEvent.SequenceNumber(), nChunkDeadline, vChunks)) {
+            LogPrintf("%s -- Skipped %s record for %s\n", __func__, strOperationType, stringFromVch(linkInfo.vchFullObjectPath));
+            continue;
         }
-        CRecordHeader header(strHeaderHex);
-        if (!header.IsNull() && nTotalSlots >= header.nChunks) {
-            std::vector<CDataChunk> vChunks;
-            for(unsigned int i = 0; i < header.nChunks; i++) {
-                std::string strChunkSalt = strOperationType + ":" + std::to_string(i+1);
-                std::array <char, 32> arrPubKey;
-                aux::from_hex(eventHeader.second.PublicKey(), arrPubKey.data());
-                SubmitGet(arrPubKey, strChunkSalt);
-                MilliSleep(20);
-            }
+        CDataRecord record(strOperationType, nTotalSlots, CRecordHeader(GetEventValue(headerEvent)), vChunks, Array32ToVector(linkInfo.arrReceivePrivateSeed));
+        if (record.HasError()) {
+            strErrorMessage = strErrorMessage + strprintf("\nRecord has errors: %s\n", __func__, record.ErrorMessage());
         }
-    }
-    if (eventHeaders.size() > 0) {
-        MilliSleep(350); // Wait for records data
-        for (const std::pair<CLinkInfo, CMutableGetEvent>& eventHeader: eventHeaders)
-        {
-            std::string strHeaderHex = eventHeader.second.Value();
-            if (strHeaderHex.substr(0, 1) == "'") {
-                strHeaderHex = strHeaderHex.substr(1, strHeaderHex.size() - 2);
-            }
-            CRecordHeader header(strHeaderHex);
-            if (!header.IsNull() && nTotalSlots >= header.nChunks) {
-                bool fSkip = false;
-                std::vector<CDataChunk> vChunks;
-                for(unsigned int i = 0; i < header.nChunks; i++) {
-                    std::string strChunkSalt = strOperationType + ":" + std::to_string(i+1);
-                    std::array <char, 32> arrPubKey;
-                    aux::from_hex(eventHeader.second.PublicKey(), arrPubKey.data());
-                    CMutableGetEvent eventData;
-                    if (GetDataFromMap(arrPubKey, strChunkSalt, eventData)) {
-                        std::string strHexValue = eventData.Value();
-                        if (strHexValue.substr(0, 1) == "'") {
-                            strHexValue = strHexValue.substr(1, strHexValue.size() - 2);
-                        }
-                        CDataChunk chunk(i, i + 1, strChunkSalt, strHexValue);
-                        vChunks.push_back(chunk);
-                    }
-                    else {
-                        bool fAuthoritative;
-                        int64_t iSequence;
-                        std::string strHeaderHex;
-                        if (SubmitGet(arrPubKey, strChunkSalt, 2000, strHeaderHex, iSequence, fAuthoritative)) {
-                            CDataChunk chunk(i, i + 1, strChunkSalt, strHeaderHex);
-                            vChunks.push_back(chunk);
-                        }
-                        else {
-                            LogPrintf("%s -- Skipped %s record for %s, chunk salt = %s\n", __func__, strOperationType, stringFromVch(eventHeader.first.vchFullObjectPath), strChunkSalt);
-                            fSkip = true;
-                            i = header.nChunks + 1; 
-                        }
-                    }
-                }
-                if (!fSkip) {
-                    // TODO: make sure all chunks and header have the same sequence number.
-                    CDataRecord record(strOperationType, nTotalSlots, header, vChunks, Array32ToVector(eventHeader.first.arrReceivePrivateSeed));
-                    if (record.HasError()) {
-                        strErrorMessage = strErrorMessage + strprintf("\nRecord has errors: %s\n", __func__, record.ErrorMessage());
-                    }
-                    else {
-                        LogPrintf("%s -- Found %s record for %s\n", __func__, strOperationType, stringFromVch(eventHeader.first.vchFullObjectPath));
-                        record.vchOwnerFQDN = eventHeader.first.vchFullObjectPath;
-                        vchRecords.push_back(record);
-                    }
-                }
-            }
+        else {
+            LogPrintf("%s -- Found %s record for %s\n", __func__, strOperationType, stringFromVch(linkInfo.vchFullObjectPath));
+            record.vchOwnerFQDN = linkInfo.vchFullObjectPath;
+            vchRecords.push_back(record);
         }
     }
     return true;
@@ -926,16 +1047,19 @@ bool SubmitPut(const std::array<char, 32> public_key, const std::array<char, 64>
         LogPrintf("%s -- chunk salt: %s, value: %s\n", __func__, chunk.Salt, entryChunkRaw.to_string());
     }
     DHT::vPutBytes.push_back(std::make_pair(nCurrentTime, newPut));
+    // Start with the least loaded session and place each following piece on the next one
+    const size_t nRunningThreads = fMultiThreads ? nThreads : 1;
+    const size_t nStart = SelectSession();
     size_t nCounter = 0;
     for (const std::pair<std::string, libtorrent::entry>& pair : newPut) {
-        if (!arraySessions[nCounter].second) {
-            strErrorMessage = strprintf("Session %d null.", nCounter);
+        const size_t nSessionThread = (nStart + nCounter) % nRunningThreads;
+        if (!arraySessions[nSessionThread].second) {
+            strErrorMessage = strprintf("Session %d null.", nSessionThread);
             return false;
         }
-        arraySessions[nCounter].second->SubmitPut(public_key, private_key, lastSequence, pair.first, pair.second);
-        LogPrintf("%s -- thread: %d, salt: %s, value: %s\n", __func__, nCounter, pair.first, pair.second.to_string());
-        if (fMultiThreads)
-            nCounter++;
+        arraySessions[nSessionThread].second->SubmitPut(public_key, private_key, lastSequence, pair.first, pair.second);
+        LogPrintf("%s -- thread: %d, salt: %s, value: %s\n", __func__, nSessionThread, pair.first, pair.second.to_string());
+        nCounter++;
     }
     nPutRecords++;
     nPutPieces += record.GetHeader().nChunks + 1;
@@ -1019,6 +1143,71 @@ bool GetAllDHTGetEvents(const size_t nSessionThread, std::vector<CMutableGetEven
     return arraySessions[nSessionThread].second->GetAllDHTGetEvents(vchGetEvents);
 }
 
+static std::atomic<size_t> nNextSession{0};
+
+size_t SelectSession()
+{
+    // Rotate the starting point so idle sessions share the work evenly
+    const size_t nRunningThreads = fMultiThreads ? nThreads : 1;
+    const size_t nStart = nNextSession++ % nRunningThreads;
+    size_t nBest = nStart;
+    int nBestLoad = std::numeric_limits<int>::max();
+    for (size_t i = 0; i < nRunningThreads; i++) {
+        const size_t n = (nStart + i) % nRunningThreads;
+        const std::shared_ptr<CHashTableSession>& pSession = arraySessions[n].second;
+        if (!pSession || !pSession->Session)
+            continue;
+        const int nLoad = pSession->PendingRequests();
+        if (nLoad < nBestLoad) {
+            nBest = n;
+            nBestLoad = nLoad;
+        }
+    }
+    return nBest;
+}
+
+size_t GetReannounceSession(const std::vector<unsigned char>& vchInfoHash)
+{
+    const size_t nRunningThreads = fMultiThreads ? nThreads : 1;
+    uint32_t nHash = 0;
+    for (size_t i = 0; i < vchInfoHash.size() && i < sizeof(nHash); i++) {
+        nHash = (nHash << 8) | vchInfoHash[i];
+    }
+    return nHash % nRunningThreads;
+}
+
+bool SubmitGet(const std::array<char, 32>& public_key, const std::string& recordSalt, const int64_t& timeout, 
+                            std::string& recordValue, int64_t& lastSequence, bool& fAuthoritative)
+{
+    return SubmitGet(SelectSession(), public_key, recordSalt, timeout, recordValue, lastSequence, fAuthoritative);
+}
+
+bool SubmitGetRecord(const std::array<char, 32>& public_key, const std::array<char, 32>& private_seed, 
+                        const std::string& strOperationType, int64_t& iSequence, CDataRecord& record)
+{
+    return SubmitGetRecord(SelectSession(), public_key, private_seed, strOperationType, iSequence, record);
+}
+
+bool SubmitGetAllRecordsSync(const std::vector<CLinkInfo>& vchLinkInfo, const std::string& strOperationType, std::vector<CDataRecord>& vchRecords)
+{
+    return SubmitGetAllRecordsSync(SelectSession(), vchLinkInfo, strOperationType, vchRecords);
+}
+
+bool SubmitGetAllRecordsAsync(const std::vector<CLinkInfo>& vchLinkInfo, const std::string& strOperationType, std::vector<CDataRecord>& vchRecords)
+{
+    return SubmitGetAllRecordsAsync(SelectSession(), vchLinkInfo, strOperationType, vchRecords);
+}
+
+bool GetAllDHTGetEvents(std::vector<CMutableGetEvent>& vchGetEvents)
+{
+    size_t nRunningThreads = fMultiThreads ? nThreads : 1;
+    for (unsigned int i = 0; i < nRunningThreads; i++) {
+        if (!GetAllDHTGetEvents(i, vchGetEvents))
+            return false;
+    }
+    return true;
+}
+
 void GetDHTStats(CSessionStats& stats)
 {
     CSessionStats newStats;
@@ -1034,6 +1223,9 @@ void GetDHTStats(CSessionStats& stats)
 
     std::vector<libtorrent::stats_metric> vStats = session_stats_metrics();
     newStats.nSessions = nRunningThreads;
+    for (unsigned int i = 0; i < nRunningThreads; i++) {
+        newStats.vQueueDepths.push_back(std::make_pair(arraySessions[i].second->pendingGets.Count(), arraySessions[i].second->pendingPuts.Count()));
+    }
     for (unsigned int i = 0; i < nRunningThreads; i++) {
         libtorrent::session_stats_alert* statsAlert = arraySessions[i].second->SessionStats;
         if (statsAlert) {
@@ -1063,16 +1255,29 @@ void GetDHTStats(CSessionStats& stats)
     newStats.nGetBytes = nGetBytes;
     newStats.nGetErrors = nGetErrors;
 
+    {
+        LOCK(cs_reannounce);
+        newStats.reannounce = reannounceStats;
+    }
+
+    CLRUCacheStats cacheStats = GetDHTStorageCacheStats();
+    newStats.nCacheHits = cacheStats.nHits;
+    newStats.nCacheMisses = cacheStats.nMisses;
+    newStats.nCacheEvictions = cacheStats.nEvictions;
+    newStats.nCacheEntries = cacheStats.nEntries;
+    newStats.nCacheBytes = cacheStats.nBytes;
+
     // get dht_global_nodes
     stats = newStats;
 }
 
 bool ReannounceEntry(const CMutableData& mutableData)
 {
-    if (arraySessions.size() == 0 || !arraySessions[0].second)
+    const size_t nSessionThread = GetReannounceSession(mutableData.vchInfoHash);
+    if (!arraySessions[nSessionThread].second)
         return false;
 
-    return arraySessions[0].second->ReannounceEntry(mutableData);
+    return arraySessions[nSessionThread].second->ReannounceEntry(mutableData);
 }
 
 void GetEvents(const int64_t& startTime, std::vector<CEvent>& events)
@@ -15,7 +15,10 @@
 #include "libtorrent/session.hpp"
 #include "libtorrent/session_status.hpp"
 
+#include <atomic>
+#include <deque>
 #include <map> // for std::map and std::multimap
+#include <memory>
 
 class CChainParams;
 class CConnman;
@@ -28,6 +31,7 @@ class CMutableGetEvent;
 typedef std::pair<int64_t, CEvent> EventPair;
 typedef std::multimap<int, EventPair> EventTypeMap;
 typedef std::map<std::string, CMutableGetEvent> DHTGetEventMap;
+typedef std::map<std::string, MutableGetRequestRef> DHTGetRequestMap;
 
 static constexpr int DHT_BOOTSTRAP_ALERT_TYPE_CODE = 62;
 static constexpr int STATS_ALERT_TYPE_CODE = 70;
@@ -38,9 +42,31 @@ static constexpr int DHT_STATS_ALERT_TYPE_CODE = 83;
 
 static constexpr int64_t DHT_RECORD_LOCK_SECONDS = 16;
 static constexpr uint32_t DHT_KEEP_PUT_BUFFER_SECONDS = 300;
+static constexpr int64_t DHT_GET_TIMEOUT_MILLISECONDS = 2000;
+static constexpr int64_t DHT_REANNOUNCE_ROUND_SECONDS = 60 * 60;
+/** Stored items whose signatures are verified together during a reannounce round */
+static constexpr size_t DHT_REANNOUNCE_VERIFY_BATCH = 64;
+/** Default for -dhtreannouncerate, stored items checked per minute */
+static const int64_t DEFAULT_DHT_REANNOUNCE_RATE = 60;
+static constexpr int64_t DHT_GET_REQUEST_EXPIRE_MILLISECONDS = 60000;
+/** A submitted get or put whose alert has not arrived by then is no longer counted as pending */
+static constexpr int64_t DHT_PENDING_REQUEST_EXPIRE_MILLISECONDS = 30000;
 
 typedef std::pair<std::array<char, 32>, std::string> HashRecordKey; // public key and salt pair
 
+class CReannounceStats {
+public:
+    uint64_t nRound = 0;
+    int64_t nRoundStart = 0;
+    uint64_t nRoundItems = 0;
+    uint64_t nRoundChecked = 0;
+    uint64_t nRoundReplicated = 0;
+    uint64_t nRoundReannounced = 0;
+    int64_t nLastRoundSeconds = 0;
+    uint64_t nTotalReannounced = 0;
+    uint64_t nTotalInvalid = 0;
+};
+
 class CSessionStats {
 public:
     uint8_t nSessions = 0;
@@ -53,10 +79,32 @@ public:
     uint64_t nGetBytes = 0;
     uint64_t nGlobalNodes = 0;
     uint64_t nGetErrors = 0;
+    uint64_t nCacheHits = 0;
+    uint64_t nCacheMisses = 0;
+    uint64_t nCacheEvictions = 0;
+    uint64_t nCacheEntries = 0;
+    uint64_t nCacheBytes = 0;
+    std::vector<std::pair<int, int>> vQueueDepths; // pending gets and puts per session
+    CReannounceStats reannounce;
 
     CSessionStats() {}
 };
 
+/** Gets or puts submitted to libtorrent and not answered yet, used to pick the least loaded session */
+class CPendingRequests {
+private:
+    mutable CCriticalSection cs_pending;
+    std::deque<int64_t> vSubmitTimes; // oldest first
+
+public:
+    void Add();
+    /** An alert answered a request, the oldest one stops counting */
+    void Remove();
+    /** Stop counting requests older than nTimeout, their alerts were dropped */
+    void Expire(const int64_t nTimeout);
+    int Count() const;
+};
+
 class CHashTableSession {
 public:
     std::string strName;
@@ -66,18 +114,33 @@ public:
     bool fShutdown = false;
     EventTypeMap m_EventTypeMap;
     DHTGetEventMap m_DHTGetEventMap;
+    DHTGetRequestMap m_DHTGetRequests;
     libtorrent::dht_stats_alert* DHTStats = nullptr;
     libtorrent::session_stats_alert* SessionStats = nullptr;
     CCriticalSection cs_EventMap;
     CCriticalSection cs_DHTGetEventMap;
+    CPendingRequests pendingGets;
+    CPendingRequests pendingPuts;
 
     CHashTableSession() : strName(""), vDataEntries(CDataRecordBuffer(32)), strErrorMessage(""), fShutdown(false) {};
 
     bool SubmitPut(const std::array<char, 32> public_key, const std::array<char, 64> private_key, const int64_t lastSequence, const std::string& strSalt, const libtorrent::entry& entryValue);
 
     bool SubmitGet(const std::array<char, 32>& public_key, const std::string& recordSalt);
+    /** Wait up to timeout for a mutable item, a lookup still running by then returns the newest value found as not authoritative */
     bool SubmitGet(const std::array<char, 32>& public_key, const std::string& recordSalt, const int64_t& timeout, 
                             std::string& recordValue, int64_t& lastSequence, bool& fAuthoritative);
+    /** Get a mutable item without blocking. Gets for an item already in flight share its request. */
+    MutableGetRequestRef SubmitGetAsync(const std::array<char, 32>& public_key, const std::string& recordSalt);
+    /** Request every chunk listed in a record header at once, spread over the session thread group */
+    std::vector<MutableGetRequestRef> SubmitGetChunksAsync(const std::array<char, 32>& public_key, const std::string& strOperationType, const CRecordHeader& header);
+    /** Wait until all chunk gets complete with the header's sequence number, or the deadline passes */
+    bool WaitForChunks(const std::vector<MutableGetRequestRef>& vRequests, const std::string& strOperationType, const int64_t nSequence, const int64_t nDeadline, std::vector<CDataChunk>& vChunks);
+    /** Keep the event if it is the newest value seen for a get still in flight */
+    void UpdateDHTGetRequest(const std::string& infoHash, const CMutableGetEvent& event);
+    /** Complete a get with the newest of event and the values seen before it */
+    void CompleteDHTGetRequest(const std::string& infoHash, const CMutableGetEvent& event);
+    void CleanUpDHTGetRequests(const int64_t timeout);
     /** Get a mutable record in the libtorrent DHT */
     bool SubmitGetRecord(const std::array<char, 32>& public_key, const std::array<char, 32>& private_seed, const std::string& strOperationType, int64_t& iSequence, CDataRecord& record);
     bool SubmitGetAllRecordsAsync(const std::vector<CLinkInfo>& vchLinkInfo, const std::string& strOperationType, std::vector<CDataRecord>& vchRecords);
@@ -90,9 +153,10 @@ public:
     void StopEventListener();
     bool ReannounceEntry(const CMutableData& mutableData);
     void GetEvents(const int64_t& startTime, std::vector<CEvent>& events);
+    /** Gets and puts submitted to libtorrent that have not completed yet */
+    int PendingRequests() const { return pendingGets.Count() + pendingPuts.Count(); }
 
 private:
-    bool GetDataFromMap(const std::array<char, 32>& public_key, const std::string& recordSalt, CMutableGetEvent& event);
     //bool LoadSessionState();
     //int SaveSessionState();
     //std::string GetSessionStatePath();
@@ -116,6 +180,10 @@ bool ConvertMutableEntryValue(const CMutableData& local_mut_data, libtorrent::en
 namespace DHT
 {
     bool SessionStatus();
+    /** Index of the running session with the fewest pending requests */
+    size_t SelectSession();
+    /** Session that always handles reannounce traffic for this info hash */
+    size_t GetReannounceSession(const std::vector<unsigned char>& vchInfoHash);
     bool SubmitPut(const std::array<char, 32> public_key, const std::array<char, 64> private_key, const int64_t lastSequence, const CDataRecord& record, std::string& strErrorMessage);
     bool SubmitGet(const size_t nSessionThread, const std::array<char, 32>& public_key, const std::string& recordSalt);
     bool SubmitGet(const size_t nSessionThread, const std::array<char, 32>& public_key, const std::string& recordSalt, const int64_t& timeout, 
@@ -125,6 +193,16 @@ namespace DHT
     bool SubmitGetAllRecordsSync(const size_t nSessionThread, const std::vector<CLinkInfo>& vchLinkInfo, const std::string& strOperationType, std::vector<CDataRecord>& vchRecords);
     bool SubmitGetAllRecordsAsync(const size_t nSessionThread, const std::vector<CLinkInfo>& vchLinkInfo, const std::string& strOperationType, std::vector<CDataRecord>& vchRecords);
     bool GetAllDHTGetEvents(const size_t nSessionThread, std::vector<CMutableGetEvent>& vchGetEvents);
+    // Same as above, routed to the least loaded session
+    /** Wait up to timeout for a mutable item, a lookup still running by then returns the newest value found as not authoritative */
+    bool SubmitGet(const std::array<char, 32>& public_key, const std::string& recordSalt, const int64_t& timeout, 
+                            std::string& recordValue, int64_t& lastSequence, bool& fAuthoritative);
+    bool SubmitGetRecord(const std::array<char, 32>& public_key, const std::array<char, 32>& private_seed, 
+                            const std::string& strOperationType, int64_t& iSequence, CDataRecord& record);
+    bool SubmitGetAllRecordsSync(const std::vector<CLinkInfo>& vchLinkInfo, const std::string& strOperationType, std::vector<CDataRecord>& vchRecords);
+    bool SubmitGetAllRecordsAsync(const std::vector<CLinkInfo>& vchLinkInfo, const std::string& strOperationType, std::vector<CDataRecord>& vchRecords);
+    /** Get events from every running session */
+    bool GetAllDHTGetEvents(std::vector<CMutableGetEvent>& vchGetEvents);
     void GetDHTStats(CSessionStats& stats);
     bool ReannounceEntry(const CMutableData& mutableData);
     void GetEvents(const int64_t& startTime, std::vector<CEvent>& events);
@@ -18,6 +18,8 @@
 #include <libtorrent/session_status.hpp>
 #include <libtorrent/time.hpp>
 
+#include <chrono>
+
 using namespace libtorrent;
 
 CEvent::CEvent(const std::string& _message, const int _type, const uint32_t _category, const std::string& _what)
@@ -89,4 +91,44 @@ CPutRequest::CPutRequest(const CKeyEd25519& _key, const std::string& _salt, cons
     sequence = _sequence;
     value = _value;
     timestamp = GetTimeMillis();
-}
\ No newline at end of file
+}
+static bool IsNewerGetEvent(const CMutableGetEvent& event, const CMutableGetEvent& current)
+{
+    return !event.Value().empty() && (current.Value().empty() || event.SequenceNumber() > current.SequenceNumber());
+}
+
+CMutableGetRequest::CMutableGetRequest(const int64_t _nSubmitTime) : fComplete(false), nSubmitTime(_nSubmitTime)
+{
+    future = promise.get_future().share();
+}
+
+void CMutableGetRequest::Update(const CMutableGetEvent& event)
+{
+    LOCK(cs);
+    if (!fComplete && IsNewerGetEvent(event, bestEvent))
+        bestEvent = event;
+}
+
+void CMutableGetRequest::Complete(const CMutableGetEvent& event)
+{
+    LOCK(cs);
+    if (fComplete)
+        return;
+
+    promise.set_value(IsNewerGetEvent(event, bestEvent) ? event : bestEvent);
+    fComplete = true;
+}
+
+bool CMutableGetRequest::Wait(const int64_t nDeadline, CMutableGetEvent& event) const
+{
+    const int64_t nWait = std::max(nDeadline - GetTimeMillis(), (int64_t)0);
+    if (future.wait_for(std::chrono::milliseconds(nWait)) != std::future_status::ready) {
+        LOCK(cs);
+        // the lookup may have ended since the wait timed out
+        event = fComplete ? future.get() : bestEvent;
+    }
+    else {
+        event = future.get();
+    }
+    return !event.Value().empty();
+}
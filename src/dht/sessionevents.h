@@ -6,7 +6,10 @@
 #define DYNAMIC_DHT_SESSION_EVENTS_H
 
 #include "dht/ed25519.h"
+#include "sync.h"
 
+#include <future>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -154,6 +157,33 @@ public:
     }
 };
 
+/** A mutable item lookup shared by everyone waiting for it, completed by the session's event listener */
+class CMutableGetRequest {
+private:
+    mutable CCriticalSection cs;
+    std::promise<CMutableGetEvent> promise;
+    std::shared_future<CMutableGetEvent> future;
+    CMutableGetEvent bestEvent; // highest sequence number from the non-authoritative alerts so far
+    bool fComplete;
+
+public:
+    int64_t nSubmitTime;
+
+    explicit CMutableGetRequest(const int64_t _nSubmitTime);
+
+    /** Keeps a value found while the lookup is still running if it is newer than the ones before */
+    void Update(const CMutableGetEvent& event);
+    /** Ends the lookup with the newest of event and the values found before, later calls are ignored */
+    void Complete(const CMutableGetEvent& event);
+    /**
+     * Waits until the lookup ends or the deadline passes. At the deadline the newest value found so far
+     * is returned, it is not authoritative. Returns false if no value was found.
+     */
+    bool Wait(const int64_t nDeadline, CMutableGetEvent& event) const;
+};
+
+typedef std::shared_ptr<CMutableGetRequest> MutableGetRequestRef;
+
 std::string GetInfoHash(const std::string& pubkey, const std::string& salt);
 std::string GetDynodeHashID(const std::string& service_address);
 
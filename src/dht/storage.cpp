@@ -23,11 +23,51 @@
 #include <libtorrent/socket_io.hpp>
 
 #include <array>
+#include <cstring>
 #include <string>
 
 using namespace libtorrent;
 using namespace libtorrent::dht;
 
+/** Decoded mutable item ready to be copied into a DHT get response */
+struct CCachedMutableItem {
+    sequence_number seq;
+    entry value;
+    std::array<char, 64> sig;
+    std::array<char, 32> pubKey;
+};
+
+typedef std::shared_ptr<const CCachedMutableItem> CachedMutableItemRef;
+
+struct CTargetHasher {
+    size_t operator()(sha1_hash const& target) const
+    {
+        // targets are SHA1 digests, any of their bytes hash well enough
+        size_t nHash;
+        std::memcpy(&nHash, target.data(), sizeof(nHash));
+        return nHash;
+    }
+};
+
+// Shared by every session's CDHTStorage, they all serve the same mutable data database
+static CShardedLRUCache<sha1_hash, CachedMutableItemRef, CTargetHasher> mutableItemCache(DHT_STORAGE_CACHE_SHARDS, DEFAULT_DHT_STORAGE_CACHE << 20);
+
+static size_t CachedMutableItemSize(size_t nValueSize)
+{
+    // a decoded entry tree takes roughly twice the bencoded size
+    return sizeof(CCachedMutableItem) + sizeof(sha1_hash) + 64 + 2 * nValueSize;
+}
+
+void SetDHTStorageCacheSize(size_t nMaxBytes)
+{
+    mutableItemCache.SetMaxBytes(nMaxBytes);
+}
+
+CLRUCacheStats GetDHTStorageCacheStats()
+{
+    return mutableItemCache.GetStats();
+}
+
 size_t CDHTStorage::num_torrents() const
 { 
     LogPrint("dht", "CDHTStorage -- num_torrents\n");
@@ -77,73 +117,84 @@ void CDHTStorage::put_immutable_item(sha1_hash const& target, span<char const> b
     LogPrint("dht", "CDHTStorage -- put_immutable_item target = %s, buf = %s, addr = %s\n", aux::to_hex(target.to_string()), std::string(buf.data()), addr.to_string());
 }
 
+template<class T>
+static entry get_bdecode(T start, T end)
+{
+    entry e;
+    bool err = false;
+    detail::bdecode_recursive(start, end, e, err, 0);
+    if (err) return entry();
+    return e;
+}
+
+// Mutable data records are keyed by the raw 20 byte target
+static CharString TargetBytes(sha1_hash const& target)
+{
+    return CharString(target.data(), target.data() + target.size());
+}
+
+// Returns the decoded item from memory, falling back to the leveldb record and caching it
+static CachedMutableItemRef GetMutableItem(sha1_hash const& target)
+{
+    CachedMutableItemRef cachedItem;
+    if (mutableItemCache.Get(target, cachedItem))
+        return cachedItem;
+
+    CMutableData mutableData;
+    if (!GetLocalMutableData(TargetBytes(target), mutableData))
+        return nullptr;
+    if (mutableData.vchSignature.size() != ED25519_SIGTATURE_BYTE_LENGTH || mutableData.vchPublicKey.size() != ED25519_PUBLIC_KEY_BYTE_LENGTH)
+        return nullptr;
+
+    std::shared_ptr<CCachedMutableItem> newItem = std::make_shared<CCachedMutableItem>();
+    newItem->seq = sequence_number(mutableData.SequenceNumber);
+    newItem->value = get_bdecode(mutableData.vchValue.begin(), mutableData.vchValue.end());
+    std::memcpy(newItem->sig.data(), mutableData.vchSignature.data(), ED25519_SIGTATURE_BYTE_LENGTH);
+    std::memcpy(newItem->pubKey.data(), mutableData.vchPublicKey.data(), ED25519_PUBLIC_KEY_BYTE_LENGTH);
+    // Do not replace an entry a concurrent put cached after our read
+    mutableItemCache.Insert(target, newItem, CachedMutableItemSize(mutableData.vchValue.size()));
+    return newItem;
+}
+
 bool CDHTStorage::get_mutable_item_seq(sha1_hash const& target, sequence_number& seq) const
 {
     if (!fDynodeMode) // Only try to get DHT data if Dynode
         return false;
     //bool ret = pDefaultStorage->get_mutable_item_seq(target, seq);
     //return ret;
-    // TODO (DHT): Try to find entry in memory before searching leveldb
-    CMutableData mutableData;
-    std::string strInfoHash = aux::to_hex(target.to_string());
-    CharString vchInfoHash = vchFromString(strInfoHash);
-    LogPrint("dht", "CDHTStorage -- get_mutable_item_seq infohash = %s\n", strInfoHash);
-    if (!GetLocalMutableData(vchInfoHash, mutableData)) {
-        LogPrintf("********** CDHTStorage -- get_mutable_item_seq failed to get mutable entry sequence_number for infohash = %s.\n", strInfoHash);
+    CachedMutableItemRef mutableItem = GetMutableItem(target);
+    if (!mutableItem) {
+        LogPrintf("********** CDHTStorage -- get_mutable_item_seq failed to get mutable entry sequence_number for infohash = %s.\n", aux::to_hex(target.to_string()));
         return false;
     }
-    seq = dht::sequence_number(mutableData.SequenceNumber);
-    LogPrint("dht", "CDHTStorage -- get_mutable_item_seq found seq = %u\n", mutableData.SequenceNumber);
+    seq = mutableItem->seq;
+    LogPrint("dht", "CDHTStorage -- get_mutable_item_seq infohash = %s, found seq = %u\n", aux::to_hex(target.to_string()), seq.value);
     return true;
 }
 
-template<class T>
-static entry get_bdecode(T start, T end)
-{
-    entry e;
-    bool err = false;
-    detail::bdecode_recursive(start, end, e, err, 0);
-    if (err) return entry();
-    return e;
-}
-
 bool CDHTStorage::get_mutable_item(sha1_hash const& target, sequence_number const seq, bool const force_fill, entry& item) const
 {
     if (!fDynodeMode) // Only try to get DHT data if Dynode
         return false;
     //bool ret = pDefaultStorage->get_mutable_item(target, seq, force_fill, item);
     //return ret;
-    // TODO (DHT): Try to find entry in memory before searching leveldb
-    CMutableData mutableData;
-    std::string strInfoHash = aux::to_hex(target.to_string());
-    CharString vchInfoHash = vchFromString(strInfoHash);
-    if (!GetLocalMutableData(vchInfoHash, mutableData)) {
-        LogPrintf("********** CDHTStorage -- get_mutable_item failed to get mutable entry for infohash = %s.\n", strInfoHash);
+    CachedMutableItemRef mutableItem = GetMutableItem(target);
+    if (!mutableItem) {
+        LogPrintf("********** CDHTStorage -- get_mutable_item failed to get mutable entry for infohash = %s.\n", aux::to_hex(target.to_string()));
         return false;
     }
-    item["seq"] = mutableData.SequenceNumber;
-    if (force_fill || (sequence_number(0) <= seq && seq < sequence_number(mutableData.SequenceNumber)))
+    item["seq"] = mutableItem->seq.value;
+    if (force_fill || (sequence_number(0) <= seq && seq < mutableItem->seq))
     {
         LogPrint("dht", "********** CDHTStorage -- get_mutable_item data found.\n");
-        item["v"] = get_bdecode(mutableData.vchValue.begin(), mutableData.vchValue.end());
-        std::array<char, 64> sig;
-        aux::from_hex(mutableData.Signature(), sig.data());
-        item["sig"] = sig;
-        std::array<char, 32> pubKey;
-        aux::from_hex(mutableData.PublicKey(), pubKey.data());
-        item["k"] = pubKey;
+        item["v"] = mutableItem->value;
+        item["sig"] = mutableItem->sig;
+        item["k"] = mutableItem->pubKey;
     }
     LogPrint("dht", "CDHTStorage -- get_mutable_item target = %s, item = %s\n", aux::to_hex(target.to_string()), item.to_string());
     return true;
 }
 
-void ExtractValueFromSpan(std::unique_ptr<char[]>& value, const span<char const>& buf)
-{
-    int const size = int(buf.size());
-    value.reset(new char[std::size_t(size)]);
-    std::memcpy(value.get(), buf.data(), buf.size());
-}
-
 void CDHTStorage::put_mutable_item(sha1_hash const& target
     , span<char const> buf
     , signature const& sig
@@ -157,56 +208,45 @@ void CDHTStorage::put_mutable_item(sha1_hash const& target
     // TODO (DHT): Store entries in memory as well
     //pDefaultStorage->put_mutable_item(target, buf, sig, seq, pk, salt, addr);
 
-    std::string strInfoHash = aux::to_hex(target.to_string());
-    CharString vchInfoHash = vchFromString(strInfoHash);
-
-    std::unique_ptr<char[]> value;
-    ExtractValueFromSpan(value, buf);
-    std::string strPutValue = std::string(value.get(), buf.size());
-    CharString vchPutValue = vchFromString(strPutValue);
-
-    std::string strSignature = aux::to_hex(std::string(sig.bytes.data(), ED25519_SIGTATURE_BYTE_LENGTH));
-    CharString vchSignature = vchFromString(strSignature);
-
-    std::string strPublicKey = aux::to_hex(std::string(pk.bytes.data(), ED25519_PUBLIC_KEY_BYTE_LENGTH));
-    CharString vchPublicKey = vchFromString(strPublicKey);
-    if (!CheckPubKey(vchPublicKey)) {
-        LogPrintf("%s -- Invalid pubkey used (%s).  DHT put storage request failed.\n", __func__, strPublicKey);
+    // Admission checks run on the raw buffers and cached decisions before anything is copied
+    if (!CheckPubKey(pk.bytes)) {
+        LogPrintf("%s -- Invalid pubkey used (%s).  DHT put storage request failed.\n", __func__, aux::to_hex(pk.bytes));
         return;
     }
-    std::unique_ptr<char[]> saltValue;
-    ExtractValueFromSpan(saltValue, salt);
-    std::string strSalt = std::string(saltValue.get(), salt.size());
-    //bool CheckSalt(const std::string& strSalt, const unsigned int nHeight, std::string& strErrorMessage)
     std::string strErrorMessage;
     unsigned int nHeight = (unsigned int)chainActive.Height();
-    if (!CheckSalt(strSalt, nHeight, strErrorMessage)) {
-        LogPrintf("%s -- Invalid salt used (%s) at height %d.  DHT put storage request failed. %s\n", __func__, strSalt, nHeight, strErrorMessage);
+    if (!CheckSalt(salt.data(), salt.size(), nHeight, strErrorMessage)) {
+        LogPrintf("%s -- Invalid salt used (%s) at height %d.  DHT put storage request failed. %s\n", __func__, std::string(salt.data(), salt.size()), nHeight, strErrorMessage);
         return;
     }
-    CharString vchSalt = vchFromString(strSalt);
-
-    CMutableData putMutableData(vchInfoHash, vchPublicKey, vchSignature, seq.value, vchSalt, vchPutValue);
-    LogPrint("dht", "CDHTStorage::%s -- put_mutable_item info_hash = %s, buf_value = %s, salt = %s, seq = %d, put_size = %d, sig_size = %d, pubkey_size = %d, salt_size = %d\n", 
-                    __func__, strInfoHash, strPutValue, strSalt, putMutableData.SequenceNumber, 
-                    vchPutValue.size(), vchSignature.size(), vchPublicKey.size(), vchSalt.size());
-
-    CMutableData previousData;
-    if (!GetLocalMutableData(vchInfoHash, previousData)) {
-        if (PutLocalMutableData(vchInfoHash, putMutableData)) {
-            LogPrintf("CDHTStorage::%s added successfully\n", __func__);
-        }
+
+    if (LogAcceptCategory("dht")) {
+        LogPrint("dht", "CDHTStorage::%s -- put_mutable_item info_hash = %s, buf_value = %s, salt = %s, seq = %d, put_size = %d, salt_size = %d\n",
+                        __func__, aux::to_hex(target.to_string()), std::string(buf.data(), buf.size()), std::string(salt.data(), salt.size()), seq.value,
+                        buf.size(), salt.size());
     }
-    else {
-        if (putMutableData.SequenceNumber > previousData.SequenceNumber) {
-            if (UpdateLocalMutableData(vchInfoHash, putMutableData)) {
-                LogPrintf("CDHTStorage::%s updated successfully\n", __func__);
-            }
-        }
-        else {
-            LogPrintf("CDHTStorage::%s value unchanged. No database operation needed.\n", __func__);
-        }
+
+    // Serialized straight from libtorrent's buffers, the sequence number compare and write happen under one lock
+    CMutableDataView putData(target.data(), pk.bytes.data(), sig.bytes.data(), seq.value, salt.data(), salt.size(), buf.data(), buf.size());
+    bool fStored = false;
+    if (!PutLocalMutableDataIfNewer(TargetBytes(target), putData, fStored)) {
+        LogPrintf("CDHTStorage::%s -- database write failed\n", __func__);
+        return;
     }
+    if (!fStored) {
+        LogPrint("dht", "CDHTStorage::%s value unchanged. No database operation needed.\n", __func__);
+        return;
+    }
+    LogPrint("dht", "CDHTStorage::%s stored successfully\n", __func__);
+
+    std::shared_ptr<CCachedMutableItem> newItem = std::make_shared<CCachedMutableItem>();
+    newItem->seq = seq;
+    newItem->value = get_bdecode(buf.begin(), buf.end());
+    newItem->sig = sig.bytes;
+    newItem->pubKey = pk.bytes;
+    // A concurrent put of a higher sequence number can reach the cache first, never replace it with this older item
+    mutableItemCache.PutIf(target, newItem, CachedMutableItemSize(buf.size()),
+        [&seq](const CachedMutableItemRef& cachedItem) { return cachedItem->seq < seq; });
     // TODO: Log from address (addr). See touch_item in the default storage implementation.
     return;
 }
@@ -5,12 +5,19 @@
 #ifndef DYNAMIC_DHT_STORAGE_H
 #define DYNAMIC_DHT_STORAGE_H
 
+#include "dht/lrucache.h"
+
 #include <libtorrent/kademlia/dht_storage.hpp>
 #include <libtorrent/kademlia/dht_settings.hpp>
 
 using namespace libtorrent;
 using namespace libtorrent::dht;
 
+/** Default for -dhtstoragecache, in MiB */
+static const int64_t DEFAULT_DHT_STORAGE_CACHE = 32;
+/** Number of independently locked shards in the mutable item cache */
+static const size_t DHT_STORAGE_CACHE_SHARDS = 16;
+
 class CDHTStorage final : public dht_storage_interface
 {
 public:
@@ -53,7 +60,9 @@ private:
 
 };
 
-void ExtractValueFromSpan(std::unique_ptr<char[]>& value, const span<char const>& buf);
+/** Resize the in-memory mutable item cache shared by all DHT sessions */
+void SetDHTStorageCacheSize(size_t nMaxBytes);
+CLRUCacheStats GetDHTStorageCacheStats();
 
 std::unique_ptr<dht_storage_interface> CDHTStorageConstructor(dht_settings const& settings);
 
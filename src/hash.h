@@ -8,7 +8,9 @@
 #ifndef DYNAMIC_HASH_H
 #define DYNAMIC_HASH_H
 
+#include "crypto/argon2d/arena.h"
 #include "crypto/argon2d/argon2.h"
+#include "crypto/argon2d/lanepool.h"
 #include "crypto/blake2/blake2.h"
 #include "crypto/ripemd160.h"
 #include "crypto/sha256.h"
@@ -306,7 +308,7 @@ uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256& val, uint3
 /// Associated data length: 0
 /// Memory cost: 500 kibibytes
 /// Lanes: 8 parallel thread
-/// Threads: 1 threads
+/// Threads: 1 thread, or the validation lane pool size (see crypto/argon2d/lanepool.h)
 /// Time Constraint: 2 iteration
 inline int Argon2d_Phase1_Hash(const void* in, const size_t size, const void* out)
 {
@@ -321,18 +323,47 @@ inline int Argon2d_Phase1_Hash(const void* in, const size_t size, const void* ou
     context.secretlen = 0;
     context.ad = NULL;
     context.adlen = 0;
-    context.allocate_cbk = NULL;
-    context.free_cbk = NULL;
+    context.allocate_cbk = Argon2dArenaAllocate; // reuse this thread's working memory
+    context.free_cbk = Argon2dArenaFree;
     context.flags = DEFAULT_ARGON2_FLAG; // = ARGON2_DEFAULT_FLAGS
     // main configurable Argon2 hash parameters
     context.m_cost = 500; // Memory in KiB (512KB)
     context.lanes = 8;    // Degree of Parallelism
-    context.threads = 1;  // Threads
+    context.threads = Argon2dLaneThreads(); // Threads, does not change the output
     context.t_cost = 2;   // Iterations
 
     return argon2_ctx(&context, Argon2_d);
 }
 
+/// Argon2d Phase 1 Hash of nCount consecutive nonces of a block header,
+/// with the same parameters as above. The nonce is the last field of the
+/// header; hashing starts from the nonce in the header and hash i goes to out[i].
+/// Memory and the inputs preceding the nonce are set up once for the batch.
+inline int Argon2d_Phase1_HashNonces(uint8_t* header, const uint32_t nCount, uint256* out)
+{
+    argon2_context context;
+    context.out = (uint8_t*)out;
+    context.outlen = (uint32_t)OUTPUT_BYTES;
+    context.pwd = header;
+    context.pwdlen = (uint32_t)INPUT_BYTES;
+    context.salt = header; //salt = input, follows the nonce
+    context.saltlen = (uint32_t)INPUT_BYTES;
+    context.secret = NULL;
+    context.secretlen = 0;
+    context.ad = NULL;
+    context.adlen = 0;
+    context.allocate_cbk = Argon2dArenaAllocate; // reuse this thread's working memory
+    context.free_cbk = Argon2dArenaFree;
+    context.flags = DEFAULT_ARGON2_FLAG; // = ARGON2_DEFAULT_FLAGS
+    // main configurable Argon2 hash parameters
+    context.m_cost = 500; // Memory in KiB (512KB)
+    context.lanes = 8;    // Degree of Parallelism
+    context.threads = Argon2dLaneThreads(); // Threads, does not change the output
+    context.t_cost = 2;   // Iterations
+
+    return argon2d_ctx_nonces(&context, (uint32_t)(INPUT_BYTES - sizeof(uint32_t)), nCount);
+}
+
 /// Argon2d Phase 2 Hash parameters
 /// Salt and password are the block header.
 /// Output length: 32 bytes.
@@ -346,7 +377,7 @@ inline int Argon2d_Phase1_Hash(const void* in, const size_t size, const void* ou
 /// Associated data length: 0
 /// Memory cost: 8000 kibibytes
 /// Lanes: 64 parallel threads
-/// Threads: 1 threads
+/// Threads: 1 thread, or the validation lane pool size (see crypto/argon2d/lanepool.h)
 /// Time Constraint: 2 iterations
 inline int Argon2d_Phase2_Hash(const void* in, const size_t size, const void* out)
 {
@@ -361,13 +392,13 @@ inline int Argon2d_Phase2_Hash(const void* in, const size_t size, const void* ou
     context.secretlen = 0;
     context.ad = NULL;
     context.adlen = 0;
-    context.allocate_cbk = NULL;
-    context.free_cbk = NULL;
+    context.allocate_cbk = Argon2dArenaAllocate; // reuse this thread's working memory
+    context.free_cbk = Argon2dArenaFree;
     context.flags = DEFAULT_ARGON2_FLAG; // = ARGON2_DEFAULT_FLAGS
     // main configurable Argon2 hash parameters
     context.m_cost = 8000; // Memory in KiB (~8192KB)
     context.lanes = 64;    // Degree of Parallelism
-    context.threads = 1;   // Threads
+    context.threads = Argon2dLaneThreads(); // Threads, does not change the output
     context.t_cost = 2;    // Iterations
 
     return argon2_ctx(&context, Argon2_d);
@@ -25,6 +25,7 @@
 #include "dht/ed25519.h"
 #include "dht/session.h"
 #include "dht/mutabledb.h"
+#include "dht/storage.h"
 #include "dynode-payments.h"
 #include "dynode-sync.h"
 #include "dynodeconfig.h"
@@ -41,6 +42,7 @@
 #include "instantsend.h"
 #include "key.h"
 #include "messagesigner.h"
+#include "miner/internal/cpu-topology.h"
 #include "miner/internal/miners-controller.h"
 #include "miner/miner.h"
 #include "net.h"
@@ -53,6 +55,8 @@
 #endif // ENABLE_WALLET
 #include "compat/sanity.h"
 #include "consensus/validation.h"
+#include "crypto/argon2d/lanepool.h"
+#include "crypto/argon2d/opt.h"
 #include "privatesend-server.h"
 #include "psnotificationinterface.h"
 #include "rpc/register.h"
@@ -429,6 +433,7 @@ void Shutdown()
     ECC_Stop();
     ECC_Stop_Stealth();
     ECC_Ed25519_Stop();
+    Argon2dLanePoolStop();
     LogPrintf("%s: done\n", __func__);
 }
 
@@ -497,12 +502,14 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-checkblocks=<n>", strprintf(_("How many blocks to check at startup (default: %u, 0 = all)"), DEFAULT_CHECKBLOCKS));
     strUsage += HelpMessageOpt("-checklevel=<n>", strprintf(_("How thorough the block verification of -checkblocks is (0-4, default: %u)"), DEFAULT_CHECKLEVEL));
     strUsage += HelpMessageOpt("-conf=<file>", strprintf(_("Specify configuration file (default: %s)"), DYNAMIC_CONF_FILENAME));
+    strUsage += HelpMessageOpt("-verifyindexpow=<n>", strprintf(_("How many of the most recent block index entries to re-hash in the background after startup (default: %d, -1 = all)"), DEFAULT_VERIFYINDEXPOW));
     if (mode == HMM_DYNAMICD) {
 #if HAVE_DECL_DAEMON
         strUsage += HelpMessageOpt("-daemon", _("Run in the background as a daemon and accept commands"));
 #endif
     }
     strUsage += HelpMessageOpt("-datadir=<dir>", _("Specify data directory"));
+    strUsage += HelpMessageOpt("-bdapentrycache=<n>", strprintf(_("Set the in-memory cache for BDAP account lookups in megabytes (default: %u)"), DEFAULT_BDAP_ENTRY_CACHE));
     strUsage += HelpMessageOpt("-dbcache=<n>", strprintf(_("Set database cache size in megabytes (%d to %d, default: %d)"), nMinDbCache, nMaxDbCache, nDefaultDbCache));
     strUsage += HelpMessageOpt("-feefilter", strprintf(_("Tell other nodes to filter invs to us by our mempool min fee (default: %u)"), DEFAULT_FEEFILTER));
     strUsage += HelpMessageOpt("-loadblock=<file>", _("Imports blocks from external blk000??.dat file on startup"));
@@ -511,6 +518,8 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-mempoolexpiry=<n>", strprintf(_("Do not keep transactions in the mempool longer than <n> hours (default: %u)"), DEFAULT_MEMPOOL_EXPIRY));
     strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
                                                -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
+    strUsage += HelpMessageOpt("-powlanethreads=<n>", strprintf(_("Set the number of threads computing the Argon2d lanes of a single block hash during validation (%u to %d, 0 = auto, 1 = no concurrency, <0 = leave that many cores free, default: %d)"),
+                                               -GetNumCores(), MAX_POWLANE_THREADS, DEFAULT_POWLANE_THREADS));
 #ifndef WIN32
     strUsage += HelpMessageOpt("-pid=<file>", strprintf(_("Specify pid file (default: %s)"), DYNAMIC_PID_FILENAME));
 #endif
@@ -650,6 +659,8 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-dnconf=<file>", strprintf(_("Specify Dynode configuration file (default: %s)"), "dynode.conf"));
     strUsage += HelpMessageOpt("-dnconflock=<n>", strprintf(_("Lock Dynodes from Dynode configuration file (default: %u)"), 1));
     strUsage += HelpMessageOpt("-dynodepairingkey=<n>", _("Set the Dynode private key"));
+    strUsage += HelpMessageOpt("-dhtreannouncerate=<n>", strprintf(_("Check up to <n> stored DHT items per minute and reannounce the ones the network lost (default: %u)"), DEFAULT_DHT_REANNOUNCE_RATE));
+    strUsage += HelpMessageOpt("-dhtstoragecache=<n>", strprintf(_("Set the in-memory cache for DHT mutable items served by this Dynode in megabytes (default: %u)"), DEFAULT_DHT_STORAGE_CACHE));
 
 #ifdef ENABLE_WALLET
     strUsage += HelpMessageGroup(_("PrivateSend options:"));
@@ -685,6 +696,9 @@ std::string HelpMessage(HelpMessageMode mode)
     if (showDebug)
         strUsage += HelpMessageOpt("-blockversion=<n>", "Override block version to test forking scenarios");
 
+    strUsage += HelpMessageOpt("-minerpin", strprintf(_("Pin CPU miner threads to CPUs, spread over NUMA nodes and physical cores first (default: %u)"), DEFAULT_MINER_PIN_THREADS));
+    strUsage += HelpMessageOpt("-minercpus=<list>", _("Pin CPU miner threads to these CPUs in order instead, e.g. 0-7,16-23 (implies -minerpin)"));
+
     strUsage += HelpMessageGroup(_("RPC server options:"));
     strUsage += HelpMessageOpt("-server", _("Accept command line and JSON-RPC commands"));
     strUsage += HelpMessageOpt("-rest", strprintf(_("Accept public REST requests (default: %u)"), DEFAULT_REST_ENABLE));
@@ -985,6 +999,12 @@ void InitParameterInteraction()
             LogPrintf("%s: parameter interaction: -whitelistforcerelay=1 -> setting -whitelistrelay=1\n", __func__);
     }
 
+    // an explicit miner CPU list is only used by pinned threads
+    if (IsArgSet("-minercpus")) {
+        if (SoftSetBoolArg("-minerpin", true))
+            LogPrintf("%s: parameter interaction: -minercpus set -> setting -minerpin=1\n", __func__);
+    }
+
 #ifdef ENABLE_WALLET
     int nLiqProvTmp = GetArg("-liquidityprovider", DEFAULT_PRIVATESEND_LIQUIDITY);
     if (nLiqProvTmp > 0) {
@@ -1233,6 +1253,18 @@ bool AppInitParameterInteraction()
     else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
         nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
 
+    // -powlanethreads=0 means autodetect; the validating thread counts as one of them
+    nPowLaneThreads = GetArg("-powlanethreads", DEFAULT_POWLANE_THREADS);
+    if (nPowLaneThreads <= 0)
+        nPowLaneThreads += GetNumCores();
+    if (nPowLaneThreads < 1)
+        nPowLaneThreads = 1;
+    else if (nPowLaneThreads > MAX_POWLANE_THREADS)
+        nPowLaneThreads = MAX_POWLANE_THREADS;
+
+    if (IsArgSet("-minercpus") && ParseCPUList(GetArg("-minercpus", ""), GetHardwareThreadCount()).empty())
+        return InitError(strprintf(_("Invalid CPU list for -minercpus: '%s', CPU numbers must be below %d"), GetArg("-minercpus", ""), GetHardwareThreadCount()));
+
     // block pruning; get the amount of disk space (in MiB) to allot for block & undo files
     int64_t nPruneArg = GetArg("-prune", 0);
     if (nPruneArg < 0) {
@@ -1391,6 +1423,14 @@ bool AppInitSanityChecks()
     ECC_Start_Stealth();
     ECC_Ed25519_Start();
     globalVerifyHandle.reset(new ECCVerifyHandle());
+    std::string argon2d_impl = argon2d_autodetect();
+    LogPrintf("Using the '%s' Argon2d implementation\n", argon2d_impl);
+    // Argon2d is only used as a proof-of-work hash here: its inputs are block headers and
+    // VGP message proofs, all public, and no password or key is ever derived with it. The
+    // wipe after every hash protects secrets left in the working memory, which this use does
+    // not have, and it costs a full pass over the memory per hash. Each thread's memory is
+    // reused for its next hash, see crypto/argon2d/arena.h.
+    FLAG_clear_internal_memory = 0;
 
     // Sanity check
     if (!InitSanityCheck())
@@ -1437,9 +1477,13 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     InitSignatureCache();
 
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
+    LogPrintf("Using %u threads per Argon2d block hash during validation\n", nPowLaneThreads);
+    Argon2dLanePoolStart(nPowLaneThreads - 1);
     if (nScriptCheckThreads) {
         for (int i = 0; i < nScriptCheckThreads - 1; i++)
             threadGroup.create_thread(&ThreadScriptCheck);
+        for (int i = 0; i < nScriptCheckThreads - 1; i++)
+            threadGroup.create_thread(&ThreadHeaderCheck);
     }
 
     std::vector<std::string> vSporkAddresses;
@@ -1737,6 +1781,7 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                 pBanAccountDB = new CBanAccountDB(nTotalCache * 35, false, fReindex, obfuscate);
                 // Init BDAP Services DBs 
                 pDomainEntryDB = new CDomainEntryDB(nTotalCache * 35, false, fReindex, obfuscate);
+                pDomainEntryDB->SetEntryCacheSize(std::max(GetArg("-bdapentrycache", DEFAULT_BDAP_ENTRY_CACHE), (int64_t)0) << 20);
                 pLinkDB = new CLinkDB(nTotalCache * 35, false, fReindex, obfuscate);
                 pLinkManager = new CLinkManager();
                 // Init DHT Services DB
@@ -1753,6 +1798,10 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                         strLoadError = _("Error upgrading chainstate database");
                         break;
                     }
+                    if (!pMutableDataDB->Upgrade()) {
+                        strLoadError = _("Error upgrading DHT mutable data database");
+                        break;
+                    }
                 }
                 if (fRequestShutdown)
                     break;
@@ -1773,6 +1822,18 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                     break;
                 }
 
+                // Build the BDAP entry indexes, a wiped database only records the index version
+                uint64_t nTipMedianTimePast = 0;
+                {
+                    LOCK(cs_main);
+                    if (chainActive.Tip())
+                        nTipMedianTimePast = chainActive.Tip()->GetMedianTimePast();
+                }
+                if (!pDomainEntryDB->Upgrade(nTipMedianTimePast)) {
+                    strLoadError = _("Error upgrading BDAP entry database");
+                    break;
+                }
+
                 // Check for changed -txindex state
                 if (fTxIndex != GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
                     strLoadError = _("You need to rebuild the database using -reindex-chainstate to change -txindex");
@@ -1910,6 +1971,11 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
         uiInterface.NotifyBlockTip.disconnect(BlockNotifyGenesisWait);
     }
 
+    // Stored block hashes were trusted while loading the block index, check them in the background
+    int nVerifyIndexPoW = GetArg("-verifyindexpow", DEFAULT_VERIFYINDEXPOW);
+    if (nVerifyIndexPoW != 0 && !fReindex)
+        threadGroup.create_thread(boost::bind(&ThreadVerifyBlockIndexPoW, nVerifyIndexPoW));
+
     // ********************************************************* Step 11a: setup PrivateSend
     fDynodeMode = GetBoolArg("-dynode", false);
     // TODO: dynode should have no wallet
@@ -2110,6 +2176,7 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     }
 
     // Start the DHT Torrent networks in the background
+    SetDHTStorageCacheSize(std::max(GetArg("-dhtstoragecache", DEFAULT_DHT_STORAGE_CACHE), (int64_t)0) << 20);
     const bool fMultiSessions = GetArg("-multidhtsessions", true);
     StartTorrentDHTNetwork(fMultiSessions, chainparams, connman);
     // ********************************************************* Step 13: finished
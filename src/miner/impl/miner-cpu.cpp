@@ -1,28 +1,82 @@
-
 // Copyright (c) 2019 Duality Blockchain Solutions Developers
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "miner/impl/miner-cpu.h"
+#include "crypto/argon2d/arena.h"
+#include "miner/internal/cpu-topology.h"
+#include "miner/miner-util.h"
 #include "primitives/block.h"
+#include "util.h"
+
+#include <algorithm>
 
+// Nonces hashed per call into the Argon2d kernel
+static const uint32_t CPU_MINER_NONCE_BATCH = 16;
 
 CPUMiner::CPUMiner(MinerContextRef ctx, std::size_t device_index)
     : MinerBase(ctx, device_index){};
 
+// Returns CPUs for miner threads, in the order the threads are started
+static const std::vector<CPUInfo>& GetMinerPlacement()
+{
+    static const std::vector<CPUInfo> placement = [] {
+        std::vector<CPUInfo> cpus;
+        if (!GetBoolArg("-minerpin", DEFAULT_MINER_PIN_THREADS))
+            return cpus;
+        std::vector<CPUInfo> topology = ReadCPUTopology();
+        if (!IsArgSet("-minercpus"))
+            return OrderCPUPlacement(topology);
+        for (int cpu : ParseCPUList(GetArg("-minercpus", ""), GetHardwareThreadCount())) {
+            // CPUs missing from sysfs get the default memory policy
+            CPUInfo info{cpu, -1, cpu};
+            for (const CPUInfo& known : topology) {
+                if (known.cpu == cpu)
+                    info = known;
+            }
+            cpus.push_back(info);
+        }
+        return cpus;
+    }();
+    return placement;
+}
+
+void CPUMiner::BindThread(std::size_t thread_index)
+{
+    const std::vector<CPUInfo>& placement = GetMinerPlacement();
+    if (placement.empty())
+        return;
+    const CPUInfo& info = placement[thread_index % placement.size()];
+    if (!PinThreadToCPU(info.cpu)) {
+        LogPrintf("DynamicMiner -- could not pin CPU thread %u to CPU %d\n", thread_index, info.cpu);
+        return;
+    }
+    // The arena is mapped on the next hash, from this node
+    Argon2dArenaBindNode(info.node);
+    LogPrintf("DynamicMiner -- CPU thread %u pinned to CPU %d (node %d)\n", thread_index, info.cpu, info.node);
+}
+
 int64_t CPUMiner::TryMineBlock(CBlock& block)
 {
-    int64_t hashes_done = 0;
-    while (true) {
-        uint256 hash = block.GetHash();
-        if (UintToArith256(hash) <= _hash_target) {
-            this->ProcessFoundSolution(block, hash);
-            break;
+    // Hash one batch, without running past the nonce that would
+    // wrap around the header template.
+    uint32_t count = std::min<uint32_t>(CPU_MINER_NONCE_BATCH, 0xffffffff - block.nNonce);
+    if (count == 0)
+        return 0;
+    uint256 hashes[CPU_MINER_NONCE_BATCH];
+    int64_t start_time = GetTimeMicros();
+    if (!block.ComputeHashes(count, hashes)) {
+        // unset hashes would pass any target, stop this thread instead of submitting them
+        throw std::runtime_error("Argon2d nonce batch hashing failed");
+    }
+    _ctx->shared->stats.hash_time.Add(GetTimeMicros() - start_time, count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (UintToArith256(hashes[i]) <= _hash_target) {
+            block.nNonce += i;
+            this->ProcessFoundSolution(block, hashes[i]);
+            return i + 1;
         }
-        block.nNonce += 1;
-        hashes_done += 1;
-        if ((block.nNonce & 0xFF) == 0)
-            break;
     }
-    return hashes_done;
+    block.nNonce += count;
+    return count;
 }
@@ -29,6 +29,9 @@ public:
 
     virtual const char* DeviceName() override { return "CPU"; };
 
+    // Pins the thread to its CPU and keeps its hashing memory on that NUMA node
+    virtual void BindThread(std::size_t thread_index) override;
+
 protected:
     virtual int64_t TryMineBlock(CBlock& block) override;
 };
@@ -0,0 +1,137 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "miner/internal/cpu-topology.h"
+
+#if defined(HAVE_CONFIG_H)
+#include "config/dynamic-config.h"
+#endif
+
+#include "tinyformat.h"
+#include "utilstrencodings.h"
+
+#ifdef WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <thread>
+
+#include <boost/algorithm/string.hpp>
+
+static const char* SYSFS_CPU = "/sys/devices/system/cpu";
+static const char* SYSFS_NODE = "/sys/devices/system/node";
+// Upper bound for CPU numbers in sysfs lists, which may include offline CPUs
+static const int SYSFS_MAX_CPUS = 4096;
+
+std::vector<int> ParseCPUList(const std::string& list, int max_cpus)
+{
+    std::vector<int> cpus;
+    std::vector<std::string> ranges;
+    boost::split(ranges, list, boost::is_any_of(","));
+    for (std::string range : ranges) {
+        boost::trim(range);
+        if (range.empty())
+            continue;
+        size_t dash = range.find('-');
+        int32_t first, last;
+        if (dash == std::string::npos) {
+            if (!ParseInt32(range, &first))
+                return std::vector<int>();
+            last = first;
+        } else if (!ParseInt32(range.substr(0, dash), &first) || !ParseInt32(range.substr(dash + 1), &last)) {
+            return std::vector<int>();
+        }
+        if (first < 0 || last < first || last >= max_cpus)
+            return std::vector<int>();
+        for (int cpu = first; cpu <= last; cpu++)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+static std::vector<int> ReadSysfsCPUList(const std::string& path)
+{
+    std::ifstream file(path);
+    std::string line;
+    if (!file || !std::getline(file, line))
+        return std::vector<int>();
+    return ParseCPUList(line, SYSFS_MAX_CPUS);
+}
+
+int GetHardwareThreadCount()
+{
+    return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+std::vector<CPUInfo> ReadCPUTopology()
+{
+    std::vector<CPUInfo> cpus;
+    for (int cpu : ReadSysfsCPUList(strprintf("%s/online", SYSFS_CPU))) {
+        std::vector<int> siblings = ReadSysfsCPUList(strprintf("%s/cpu%d/topology/thread_siblings_list", SYSFS_CPU, cpu));
+        int core = siblings.empty() ? cpu : *std::min_element(siblings.begin(), siblings.end());
+        cpus.push_back(CPUInfo{cpu, 0, core});
+    }
+    if (cpus.empty()) {
+        int count = GetHardwareThreadCount();
+        for (int cpu = 0; cpu < count; cpu++)
+            cpus.push_back(CPUInfo{cpu, 0, cpu});
+        return cpus;
+    }
+
+    for (int node : ReadSysfsCPUList(strprintf("%s/online", SYSFS_NODE))) {
+        for (int cpu : ReadSysfsCPUList(strprintf("%s/node%d/cpulist", SYSFS_NODE, node))) {
+            for (CPUInfo& info : cpus) {
+                if (info.cpu == cpu)
+                    info.node = node;
+            }
+        }
+    }
+    return cpus;
+}
+
+std::vector<CPUInfo> OrderCPUPlacement(const std::vector<CPUInfo>& cpus)
+{
+    // Per node, first the lowest logical CPU of every core, then its siblings
+    std::map<int, std::vector<CPUInfo> > nodes;
+    for (const CPUInfo& info : cpus)
+        nodes[info.node].push_back(info);
+    for (auto& node : nodes) {
+        std::stable_sort(node.second.begin(), node.second.end(), [](const CPUInfo& a, const CPUInfo& b) {
+            return (a.cpu != a.core) < (b.cpu != b.core);
+        });
+    }
+
+    std::vector<CPUInfo> placement;
+    for (size_t i = 0; placement.size() < cpus.size(); i++) {
+        for (const auto& node : nodes) {
+            if (i < node.second.size())
+                placement.push_back(node.second[i]);
+        }
+    }
+    return placement;
+}
+
+bool PinThreadToCPU(int cpu)
+{
+#ifdef WIN32
+    if (cpu < 0 || cpu >= (int)(8 * sizeof(DWORD_PTR)))
+        return false;
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
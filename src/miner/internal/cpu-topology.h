@@ -0,0 +1,42 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DYNAMIC_INTERNAL_CPU_TOPOLOGY_H
+#define DYNAMIC_INTERNAL_CPU_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Logical CPU as seen by the miner thread placement.
+ */
+struct CPUInfo {
+    // Logical CPU number
+    int cpu;
+    // NUMA node, 0 when the system exposes no NUMA information
+    int node;
+    // Lowest logical CPU of the physical core, shared by SMT siblings
+    int core;
+};
+
+// Parses a Linux cpulist such as "0-3,8,10-11", returns an empty list on error
+// or if a CPU number is not below max_cpus
+std::vector<int> ParseCPUList(const std::string& list, int max_cpus);
+
+// Number of hardware threads, the bound for user supplied CPU lists
+int GetHardwareThreadCount();
+
+// Reads online CPUs, their NUMA node and SMT siblings from sysfs.
+// Elsewhere, or if sysfs is not readable, every CPU is its own core on node 0.
+std::vector<CPUInfo> ReadCPUTopology();
+
+// Orders CPUs for miner threads: alternates between NUMA nodes so every
+// memory controller gets the same share of threads, and uses each physical
+// core once before its SMT siblings.
+std::vector<CPUInfo> OrderCPUPlacement(const std::vector<CPUInfo>& cpus);
+
+// Pins the calling thread to one logical CPU, returns false if unsupported
+bool PinThreadToCPU(int cpu);
+
+#endif // DYNAMIC_INTERNAL_CPU_TOPOLOGY_H
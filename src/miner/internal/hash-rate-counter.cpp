@@ -6,6 +6,9 @@
 #include "miner/internal/hash-rate-counter.h"
 #include "utiltime.h"
 
+#include <algorithm>
+
+const int HashRateCounter::HISTORY_SECONDS;
 
 void HashRateCounter::Increment(int64_t amount)
 {
@@ -19,6 +22,16 @@ void HashRateCounter::Increment(int64_t amount)
     if (_parent) {
         _parent->Increment(amount);
     }
+    {
+        int64_t now = GetTime();
+        std::lock_guard<std::mutex> guard(_history_mutex);
+        int slot = now % HISTORY_SECONDS;
+        if (_history_time[slot] != now) {
+            _history_time[slot] = now;
+            _history_count[slot] = 0;
+        }
+        _history_count[slot] += amount;
+    }
     // Ignore until at least 4 seconds passed
     if (GetTimeMillis() - _timer_start < 4000) {
         return;
@@ -35,4 +48,25 @@ void HashRateCounter::Reset()
     _count = 0;
     _count_per_sec = 0;
     _timer_start = GetTimeMillis();
+
+    std::lock_guard<std::mutex> guard(_history_mutex);
+    std::fill(_history_count, _history_count + HISTORY_SECONDS, 0);
+    std::fill(_history_time, _history_time + HISTORY_SECONDS, 0);
+    _history_start = GetTime();
+}
+
+double HashRateCounter::GetRate(int seconds) const
+{
+    int64_t now = GetTime();
+    std::lock_guard<std::mutex> guard(_history_mutex);
+    seconds = std::min<int64_t>(std::min(seconds, HISTORY_SECONDS), now - _history_start);
+    if (seconds <= 0)
+        return 0.0;
+    int64_t total = 0;
+    for (int64_t time = now - seconds; time < now; time++) {
+        int slot = time % HISTORY_SECONDS;
+        if (_history_time[slot] == time)
+            total += _history_count[slot];
+    }
+    return (double)total / seconds;
 }
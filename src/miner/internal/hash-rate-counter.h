@@ -7,6 +7,7 @@
 
 #include <atomic>
 #include <memory>
+#include <mutex>
 
 
 struct HashRateCounter;
@@ -23,6 +24,13 @@ private:
 
     HashRateCounterRef _parent;
 
+    // Hashes per second over the last 15 minutes, indexed by time % HISTORY_SECONDS
+    static const int HISTORY_SECONDS = 15 * 60;
+    mutable std::mutex _history_mutex;
+    int64_t _history_count[HISTORY_SECONDS] = {};
+    int64_t _history_time[HISTORY_SECONDS] = {};
+    int64_t _history_start = 0;
+
 public:
     explicit HashRateCounter() : _parent(nullptr){};
     explicit HashRateCounter(HashRateCounterRef parent) : _parent(parent){};
@@ -39,6 +47,10 @@ public:
     // Resets counter and timer
     void Reset();
 
+    // Returns average hashes per second over the last `seconds` complete
+    // seconds (up to 15 minutes), or since the last reset if shorter
+    double GetRate(int seconds) const;
+
     // Returns start time
     int64_t start() const { return _timer_start; };
 };
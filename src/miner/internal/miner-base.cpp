@@ -34,31 +34,32 @@ void MinerBase::Loop()
 {
     LogPrintf("DynamicMiner -- started on %s#%d\n", DeviceName(), _device_index);
     SetThreadPriority(THREAD_PRIORITY_LOWEST);
+    // miners keep every core busy with their own nonces
+    Argon2dLanePoolExcludeThread();
     RenameThread(tfm::format("dynamic-%s-miner-%d", DeviceName(), _device_index).data());
 
     CBlock block;
     CBlockIndex* chain_tip = nullptr;
-    int64_t block_time = 0;
-    std::shared_ptr<CBlockTemplate> block_template = {nullptr};
+    uint64_t generation = 0;
+    MinerTemplateRef current = {nullptr};
 
     try {
         while (true) {
-            // Update block and tip if changed
-            if (block_time != _ctx->shared->block_time()) {
-                // set new block template
-                block_template = _ctx->shared->block_template();
-                block = block_template->block;
+            // Update block and tip if a new template was published
+            if (generation != _ctx->shared->generation()) {
+                // tip, template and generation are published together
+                current = _ctx->shared->current();
+                block = current->block_template->block;
                 // set block reserve script
                 SetBlockPubkeyScript(block, _coinbase_script->reserveScript);
-                // set block flag only after template
-                // so we've waited for RecreateBlock
-                block_time = _ctx->shared->block_time();
+                generation = current->generation;
                 // block template chain tip
-                chain_tip = _ctx->shared->tip();
+                chain_tip = current->tip;
+                _ctx->shared->stats.StartedHashing(generation);
             }
             // Make sure we have a tip
             assert(chain_tip != nullptr);
-            assert(block_template != nullptr);
+            assert(current != nullptr);
             // Increment nonce
             IncrementExtraNonce(block, chain_tip, _extra_nonce);
             LogPrintf("DynamicMiner -- Running miner on device %s#%d with %u transactions in block (%u bytes)\n", DeviceName(), _device_index, block.vtx.size(),
@@ -73,12 +74,15 @@ void MinerBase::Loop()
                 _ctx->counter->Increment(hashes);
                 // Check for stop or if block needs to be rebuilt
                 boost::this_thread::interruption_point();
-                // Check if block was recreated
-                if (block_time != _ctx->shared->block_time()) {
+                // Check if a new template was published
+                if (generation != _ctx->shared->generation()) {
                     break;
                 }
                 // Recreate block if nonce too big
                 if (block.nNonce >= 0xffff0000) {
+                    // the next extra nonce starts a fresh nonce range
+                    // when the template has not changed
+                    block.nNonce = 0;
                     _ctx->shared->RecreateBlock();
                     break;
                 }
@@ -109,7 +113,13 @@ void MinerBase::ProcessFoundSolution(const CBlock& block, const uint256& hash)
     // Found a solution
     SetThreadPriority(THREAD_PRIORITY_NORMAL);
     LogPrintf("DynamicMiner%s:\n proof-of-work found  \n  hash: %s  \ntarget: %s\n", DeviceName(), hash.GetHex(), _hash_target.GetHex());
-    ProcessBlockFound(block, _ctx->chainparams());
+    bool accepted = ProcessBlockFound(block, _ctx->chainparams());
+    bool stale;
+    {
+        LOCK(cs_main);
+        stale = block.hashPrevBlock != chainActive.Tip()->GetBlockHash() && !accepted;
+    }
+    _ctx->shared->stats.BlockFound(accepted, stale);
     SetThreadPriority(THREAD_PRIORITY_LOWEST);
     _coinbase_script->KeepScript();
 
@@ -31,11 +31,15 @@ public:
     // Returns miner device name
     virtual const char* DeviceName() = 0;
 
+    // Binds the calling thread before the loop starts,
+    // thread_index is its position in the thread group
+    virtual void BindThread(std::size_t thread_index){};
+
 protected:
     // Processes a new found solution
     void ProcessFoundSolution(const CBlock& block, const uint256& hash);
 
-    // tries to mine a block
+    // tries one batch of nonces, returns the number of hashes done
     virtual int64_t TryMineBlock(CBlock& block) = 0;
 
     // Solution must be lower or equal to
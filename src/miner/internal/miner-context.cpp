@@ -14,17 +14,46 @@ MinerContext::MinerContext(const CChainParams& chainparams_, CConnman& connman_)
 MinerContext::MinerContext(MinerSharedContextRef shared_, HashRateCounterRef counter_)
     : counter(counter_), shared(shared_){};
 
+void MinerSharedContext::Publish(CBlockIndex* tip, unsigned int txn_updated, std::unique_ptr<CBlockTemplate> block_template)
+{
+    uint64_t generation = _generation.load(std::memory_order_relaxed) + 1;
+    std::atomic_store(&_template, MinerTemplateRef(new MinerTemplate{generation, tip, txn_updated, std::move(block_template)}));
+    // miners poll the generation, so it goes out after the template
+    _generation.store(generation, std::memory_order_release);
+}
+
 void MinerSharedContext::RecreateBlock()
 {
-    // Then we acquire unique lock so that miners wait
-    // for the new block to be created
-    boost::unique_lock<boost::shared_mutex> guard(_mutex);
-    uint32_t txn_time = mempool.GetTransactionsUpdated();
+    // Lock order is cs_main, then _update_mutex: transactions
+    // are announced to AddTransaction with cs_main held
+    int64_t start_time = GetTimeMicros();
+    LOCK(cs_main);
+    std::lock_guard<std::mutex> guard(_update_mutex);
+    MinerTemplateRef current = this->current();
+    CBlockIndex* tip = chainActive.Tip();
+    unsigned int txn_updated = mempool.GetTransactionsUpdated();
     // pass if nothing changed
-    if (_chain_tip == chainActive.Tip() && _last_txn == txn_time)
+    if (current && current->tip == tip && current->txn_updated == txn_updated)
+        return;
+    // On a new tip move the miners off stale work first, with a template
+    // that skips the mempool scan, and then fill the block
+    if (current && current->tip != tip) {
+        Publish(tip, txn_updated, CreateNewBlock(chainparams, nullptr, false));
+        stats.TipTemplate(generation(), start_time, GetTimeMicros());
+    }
+    Publish(tip, txn_updated, CreateNewBlock(chainparams));
+}
+
+void MinerSharedContext::AddTransaction(const CTransaction& txn)
+{
+    LOCK(cs_main);
+    std::lock_guard<std::mutex> guard(_update_mutex);
+    MinerTemplateRef current = this->current();
+    // a new tip rebuilds the template from scratch
+    if (!current || current->tip != chainActive.Tip())
+        return;
+    std::unique_ptr<CBlockTemplate> next(new CBlockTemplate(*current->block_template));
+    if (!AddToBlockTemplate(*next, chainparams, current->tip, txn.GetHash()))
         return;
-    _chain_tip = chainActive.Tip();
-    _block_time = GetTime();
-    _block_template = CreateNewBlock(chainparams);
-    _last_txn = txn_time;
+    Publish(current->tip, mempool.GetTransactionsUpdated(), std::move(next));
 }
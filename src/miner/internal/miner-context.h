@@ -6,16 +6,17 @@
 #define DYNAMIC_INTERNAL_MINER_CONTEXT_H
 
 #include "miner/internal/hash-rate-counter.h"
-
-#include <boost/thread/locks.hpp>
-#include <boost/thread/shared_mutex.hpp>
+#include "miner/internal/miner-stats.h"
 
 #include <atomic>
+#include <memory>
+#include <mutex>
 
 class CBlock;
 class CChainParams;
 class CConnman;
 class CBlockIndex;
+class CTransaction;
 struct CBlockTemplate;
 
 class MinerBase;
@@ -26,6 +27,23 @@ class MinersController;
 /** Miner context shared_ptr */
 using MinerContextRef = std::shared_ptr<MinerContext>;
 
+/**
+ * Block template published to the miners.
+ * Never modified once published, updates publish a new one.
+ */
+struct MinerTemplate {
+    // increases with every published template
+    uint64_t generation;
+    // chain tip the template builds on
+    CBlockIndex* tip;
+    // mempool.GetTransactionsUpdated() when the template was built
+    unsigned int txn_updated;
+    // block template
+    std::shared_ptr<const CBlockTemplate> block_template;
+};
+
+using MinerTemplateRef = std::shared_ptr<const MinerTemplate>;
+
 struct MinerSharedContext {
 public:
     const CChainParams& chainparams;
@@ -34,20 +52,27 @@ public:
     MinerSharedContext(const CChainParams& chainparams_, CConnman& connman_)
         : chainparams(chainparams_), connman(connman_){};
 
-    // Returns chain tip of current block template
-    CBlockIndex* tip() const { return _chain_tip; }
+    // Mining telemetry
+    MinerStats stats;
+
+    // Returns generation of the current template, cheap enough to poll per batch
+    uint64_t generation() const { return _generation.load(std::memory_order_acquire); }
 
-    // Returns miner block template creation time
-    int64_t block_time() const { return _block_time; }
+    // Returns the current template, it never changes once returned
+    MinerTemplateRef current() const { return std::atomic_load(&_template); }
 
-    // Returns time of last transaction in the block
-    uint32_t last_txn() const { return _last_txn; }
+    // Returns chain tip of current block template
+    CBlockIndex* tip() const
+    {
+        MinerTemplateRef current = this->current();
+        return current ? current->tip : nullptr;
+    }
 
     // Returns miner block template
-    std::shared_ptr<CBlockTemplate> block_template()
+    std::shared_ptr<const CBlockTemplate> block_template() const
     {
-        boost::shared_lock<boost::shared_mutex> guard(_mutex);
-        return _block_template;
+        MinerTemplateRef current = this->current();
+        return current ? current->block_template : nullptr;
     }
 
 protected:
@@ -58,17 +83,19 @@ protected:
     // recreates miners block template
     void RecreateBlock();
 
+    // appends a transaction accepted to the mempool to the current template
+    void AddTransaction(const CTransaction& txn);
+
 private:
-    // current block chain tip
-    std::atomic<CBlockIndex*> _chain_tip{nullptr};
-    // atomic flag incremented on recreated block
-    std::atomic<int64_t> _block_time{0};
-    // last transaction update time
-    std::atomic<uint32_t> _last_txn{0};
-    // shared block template for miners
-    std::shared_ptr<CBlockTemplate> _block_template{nullptr};
-    // mutex protecting multiple threads recreating block
-    mutable boost::shared_mutex _mutex;
+    // publishes a new template, requires _update_mutex
+    void Publish(CBlockIndex* tip, unsigned int txn_updated, std::unique_ptr<CBlockTemplate> block_template);
+
+    // current template, read and replaced with std::atomic_load/atomic_store
+    MinerTemplateRef _template{nullptr};
+    // generation of _template, stored after it
+    std::atomic<uint64_t> _generation{0};
+    // serializes template updates, miners never take it
+    std::mutex _update_mutex;
 };
 
 using MinerSharedContextRef = std::shared_ptr<MinerSharedContext>;
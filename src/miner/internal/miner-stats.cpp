@@ -0,0 +1,48 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "miner/internal/miner-stats.h"
+#include "utiltime.h"
+
+
+void MinerLatency::Add(int64_t micros, int64_t count)
+{
+    if (count <= 0)
+        return;
+    _last = micros / count;
+    _total += micros;
+    _count += count;
+}
+
+double MinerLatency::average() const
+{
+    int64_t count = _count;
+    return count ? (double)_total / count : 0.0;
+}
+
+void MinerStats::BlockFound(bool accepted, bool stale)
+{
+    _found++;
+    if (accepted)
+        _accepted++;
+    if (stale)
+        _stale++;
+}
+
+void MinerStats::TipTemplate(uint64_t generation, int64_t tip_time, int64_t template_time)
+{
+    tip_to_template.Add(template_time - tip_time);
+    _pending_time = template_time;
+    _pending_generation = generation;
+}
+
+void MinerStats::StartedHashing(uint64_t generation)
+{
+    uint64_t pending = _pending_generation;
+    if (pending == 0 || generation < pending)
+        return;
+    // only the first miner on the new tip records it
+    if (_pending_generation.compare_exchange_strong(pending, 0))
+        template_to_hash.Add(GetTimeMicros() - _pending_time);
+}
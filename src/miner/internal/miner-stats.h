@@ -0,0 +1,74 @@
+// Copyright (c) 2019 Duality Blockchain Solutions Developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef DYNAMIC_INTERNAL_MINER_STATS_H
+#define DYNAMIC_INTERNAL_MINER_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Last and average of a duration in microseconds.
+ */
+struct MinerLatency {
+private:
+    std::atomic<int64_t> _last{0};
+    std::atomic<int64_t> _total{0};
+    std::atomic<int64_t> _count{0};
+
+public:
+    // Adds a sample of `count` events that took `micros` together
+    void Add(int64_t micros, int64_t count = 1);
+
+    // Returns the last sample, per event
+    double last() const { return _last; }
+
+    // Returns the average per event since start
+    double average() const;
+
+    // Returns number of events
+    int64_t count() const { return _count; }
+};
+
+/**
+ * Mining telemetry shared by all miners.
+ */
+class MinerStats
+{
+public:
+    // Counts a solution and whether validation took it or it was built on an old tip
+    void BlockFound(bool accepted, bool stale);
+
+    // Records the first template published for a new tip
+    void TipTemplate(uint64_t generation, int64_t tip_time, int64_t template_time);
+
+    // Called by a miner switching templates, the first after a new tip sets the latency
+    void StartedHashing(uint64_t generation);
+
+    // Blocks found
+    int64_t found() const { return _found; }
+    // Blocks found that validation accepted
+    int64_t accepted() const { return _accepted; }
+    // Blocks found on a template whose tip was already replaced
+    int64_t stale() const { return _stale; }
+
+    // Time from a new tip to a template on it
+    MinerLatency tip_to_template;
+    // Time from that template to the first miner hashing it
+    MinerLatency template_to_hash;
+    // Argon2d time per hash on CPU miners
+    MinerLatency hash_time;
+
+private:
+    std::atomic<int64_t> _found{0};
+    std::atomic<int64_t> _accepted{0};
+    std::atomic<int64_t> _stale{0};
+
+    // generation of the tip template nobody hashed yet, 0 if none
+    std::atomic<uint64_t> _pending_generation{0};
+    // publication time of that template
+    std::atomic<int64_t> _pending_time{0};
+};
+
+#endif // DYNAMIC_INTERNAL_MINER_STATS_H
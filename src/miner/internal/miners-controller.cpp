@@ -97,7 +97,9 @@ void MinerSignals::NotifyTransaction(const CTransaction& txn, const CBlockIndex*
     // check if blockchain has synced, has more than 1 peer and is enabled before recreating blocks
     if (IsInitialBlockDownload() || !_ctr->can_start())
         return;
-    if (GetTime() - _ctr->_ctx->shared->last_txn() > 60) {
-        _ctr->_ctx->shared->RecreateBlock();
-    }
+    // transactions connected in a block come with the new tip
+    if (posInBlock != CMainSignals::SYNC_TRANSACTION_NOT_IN_BLOCK)
+        return;
+    // extend the current template instead of rebuilding it
+    _ctr->_ctx->shared->AddTransaction(txn);
 };
@@ -44,6 +44,9 @@ public:
     // Gets combined hash rate of GPU and CPU
     int64_t GetHashRate() const;
 
+    // Returns mining telemetry
+    const MinerStats& stats() const { return _ctx->shared->stats; }
+
     // Returns CPU miners thread group
     MinersThreadGroup<CPUMiner>& group_cpu() { return _group_cpu; }
 
@@ -86,11 +89,6 @@ protected:
 
     // Set to true when user requested start
     bool _enable_start = false;
-
-    // Time of last transaction signal
-    int64_t _last_txn_time = 0;
-    // Time of last time block template was created
-    int64_t _last_sync_time = 0;
 };
 
 class MinerSignals
@@ -35,9 +35,11 @@ public:
     {
         // Set thread group size
         ThreadGroup<T, MinerContextRef>::SetSize(size);
-        // Reset hash rate counter
+        // Reset hash rate counters
         if (size == 0) {
             this->_ctx->counter->Reset();
+            for (const MinerContextRef& device : this->_device_ctx)
+                device->counter->Reset();
         }
     };
 
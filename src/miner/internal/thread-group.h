@@ -9,6 +9,8 @@
 #include <boost/thread/shared_mutex.hpp>
 #include <boost/thread/thread.hpp>
 
+#include <vector>
+
 /**
  * Miner threads controller.
  * Separate object for CPU and GPU.
@@ -46,8 +48,12 @@ public:
     // Size of a thread group
     uint8_t size() const { return _target_threads; }
 
+    // Contexts of the group devices, parents of their threads' contexts
+    const std::vector<Context>& devices() const { return _device_ctx; }
+
 protected:
     Context _ctx;
+    std::vector<Context> _device_ctx;
 
 private:
     // Starts or shutdowns threads to meet the target
@@ -63,7 +69,11 @@ private:
 /** Miners device group class constructor */
 template <class T, class Context>
 ThreadGroup<T, Context>::ThreadGroup(Context ctx)
-    : _ctx(ctx), _devices(T::TotalDevices()){};
+    : _ctx(ctx), _devices(T::TotalDevices())
+{
+    for (size_t device = 0; device < _devices; device++)
+        _device_ctx.push_back(_ctx->MakeChild());
+};
 
 template <class T, class Context>
 void ThreadGroup<T, Context>::SyncGroupTarget()
@@ -71,8 +81,10 @@ void ThreadGroup<T, Context>::SyncGroupTarget()
     size_t current;
     while ((current = _threads.size()) != _target_threads) {
         if (current < _target_threads) {
-            auto miner = std::shared_ptr<T>(new T(_ctx->MakeChild(), current % _devices));
-            _threads.push_back(std::make_shared<boost::thread>([miner] {
+            size_t device = current % _devices;
+            auto miner = std::shared_ptr<T>(new T(_device_ctx[device]->MakeChild(), device));
+            _threads.push_back(std::make_shared<boost::thread>([miner, current] {
+                miner->BindThread(current);
                 (*miner)();
             }));
         } else {
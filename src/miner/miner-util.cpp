@@ -85,7 +85,15 @@ public:
 uint64_t nLastBlockTx = 0;
 uint64_t nLastBlockSize = 0;
 
-std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams, const CScript* scriptPubKeyIn)
+static unsigned int GetBlockMaxSize()
+{
+    // Largest block you're willing to create:
+    unsigned int nBlockMaxSize = GetArg("-blockmaxsize", DEFAULT_BLOCK_MAX_SIZE);
+    // Limit to between 1K and MAX_BLOCK_SIZE-1K for sanity:
+    return std::max((unsigned int)1000, std::min((unsigned int)(MAX_BLOCK_SIZE - 1000), nBlockMaxSize));
+}
+
+std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams, const CScript* scriptPubKeyIn, bool fMempoolTxs)
 {
     // Create new block
     std::unique_ptr<CBlockTemplate> pblocktemplate(new CBlockTemplate());
@@ -99,9 +107,7 @@ std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams,
     txNew.vout.resize(1);
 
     // Largest block you're willing to create:
-    unsigned int nBlockMaxSize = GetArg("-blockmaxsize", DEFAULT_BLOCK_MAX_SIZE);
-    // Limit to between 1K and MAX_BLOCK_SIZE-1K for sanity:
-    nBlockMaxSize = std::max((unsigned int)1000, std::min((unsigned int)(MAX_BLOCK_SIZE - 1000), nBlockMaxSize));
+    unsigned int nBlockMaxSize = GetBlockMaxSize();
 
     // How much of the block should be dedicated to high-priority transactions,
     // included regardless of the fees they pay
@@ -168,7 +174,7 @@ std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams,
         CTxMemPool::indexed_transaction_set::index<mining_score>::type::iterator mi = mempool.mapTx.get<mining_score>().begin();
         CTxMemPool::txiter iter;
 
-        while (mi != mempool.mapTx.get<mining_score>().end() || !clearedTxs.empty()) {
+        while (fMempoolTxs && (mi != mempool.mapTx.get<mining_score>().end() || !clearedTxs.empty())) {
             bool priorityTx = false;
             if (fPriorityBlock && !vecPriority.empty()) { // add a tx from priority queue to fill the blockprioritysize
                 priorityTx = true;
@@ -348,6 +354,71 @@ std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams,
     return CreateNewBlock(chainparams, &scriptPubKeyIn);
 }
 
+bool AddToBlockTemplate(CBlockTemplate& blocktemplate, const CChainParams& chainparams, CBlockIndex* indexPrev, const uint256& txid)
+{
+    AssertLockHeld(cs_main);
+    LOCK(mempool.cs);
+    CTxMemPool::txiter iter = mempool.mapTx.find(txid);
+    if (iter == mempool.mapTx.end())
+        return false;
+
+    CBlock& block = blocktemplate.block;
+    const CTransaction& tx = iter->GetTx();
+    std::set<uint256> setInBlock;
+    std::set<COutPoint> setSpent;
+    uint64_t nBlockSize = 1000;
+    unsigned int nBlockSigOps = 100;
+    for (size_t i = 1; i < block.vtx.size(); i++) {
+        setInBlock.insert(block.vtx[i]->GetHash());
+        for (const CTxIn& txin : block.vtx[i]->vin)
+            setSpent.insert(txin.prevout);
+        nBlockSize += ::GetSerializeSize(*block.vtx[i], SER_NETWORK, PROTOCOL_VERSION);
+        nBlockSigOps += blocktemplate.vTxSigOps[i];
+    }
+    if (setInBlock.count(txid))
+        return false;
+    BOOST_FOREACH (CTxMemPool::txiter parent, mempool.GetMemPoolParents(iter)) {
+        if (!setInBlock.count(parent->GetTx().GetHash()))
+            return false;
+    }
+
+    // Same policy and limits as CreateNewBlock, an appended transaction never counts as high priority
+    const unsigned int nBlockMaxSize = GetBlockMaxSize();
+    const unsigned int nBlockMinSize = std::min(nBlockMaxSize, (unsigned int)GetArg("-blockminsize", DEFAULT_BLOCK_MIN_SIZE));
+    const unsigned int nTxSize = iter->GetTxSize();
+    if (iter->GetModifiedFee() < ::minRelayTxFee.GetFee(nTxSize) && nBlockSize >= nBlockMinSize)
+        return false;
+    if (nBlockSize + nTxSize >= nBlockMaxSize)
+        return false;
+    if (nBlockSigOps + iter->GetSigOpCount() >= MAX_BLOCK_SIGOPS)
+        return false;
+    const int nHeight = indexPrev->nHeight + 1;
+    int64_t nLockTimeCutoff = (STANDARD_LOCKTIME_VERIFY_FLAGS & LOCKTIME_MEDIAN_TIME_PAST) ? indexPrev->GetMedianTimePast() : block.GetBlockTime();
+    if (!IsFinalTx(tx, nHeight, nLockTimeCutoff))
+        return false;
+
+    // Only the new transaction is checked: its inputs must be unspent by the template and
+    // available from the chain or the parents already in it. Scripts were checked by the mempool.
+    for (const CTxIn& txin : tx.vin) {
+        if (setSpent.count(txin.prevout))
+            return false;
+    }
+    CCoinsViewMemPool viewMemPool(pcoinsTip, mempool);
+    CCoinsViewCache view(&viewMemPool);
+    CValidationState state;
+    if (!Consensus::CheckTxInputs(tx, state, view, nHeight)) {
+        LogPrint("mempool", "AddToBlockTemplate(): %s does not fit the template: %s\n", txid.ToString(), FormatStateMessage(state));
+        return false;
+    }
+
+    block.vtx.emplace_back(iter->GetSharedTx());
+    blocktemplate.vTxFees.push_back(iter->GetFee());
+    blocktemplate.vTxSigOps.push_back(iter->GetSigOpCount());
+    blocktemplate.vTxFees[0] -= iter->GetFee();
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    return true;
+}
+
 void IncrementExtraNonce(CBlock& block, const CBlockIndex* indexPrev, unsigned int& nExtraNonce)
 {
     // Update nExtraNonce
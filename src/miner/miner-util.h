@@ -29,6 +29,7 @@ struct Params;
 static const bool DEFAULT_GENERATE = false;
 static const uint8_t DEFAULT_GENERATE_THREADS_CPU = 0;
 static const uint8_t DEFAULT_GENERATE_THREADS_GPU = 0;
+static const bool DEFAULT_MINER_PIN_THREADS = false;
 
 static const bool DEFAULT_PRINTPRIORITY = false;
 
@@ -42,9 +43,11 @@ struct CBlockTemplate {
 
 /** Set pubkey script in generated block */
 void SetBlockPubkeyScript(CBlock& block, const CScript& scriptPubKeyIn);
-/** Generate a new block, without valid proof-of-work */
-std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams, const CScript* scriptPubKeyIn = nullptr);
+/** Generate a new block, without valid proof-of-work; fMempoolTxs = false leaves it empty but for the coinbase */
+std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams, const CScript* scriptPubKeyIn = nullptr, bool fMempoolTxs = true);
 std::unique_ptr<CBlockTemplate> CreateNewBlock(const CChainParams& chainparams, const CScript& scriptPubKeyIn);
+/** Append a mempool transaction to a copy of a template built on indexPrev, if it fits and its parents are in it (requires cs_main). Discard the copy on false. */
+bool AddToBlockTemplate(CBlockTemplate& blocktemplate, const CChainParams& chainparams, CBlockIndex* indexPrev, const uint256& txid);
 /** Called by a miner when new block was found. */
 bool ProcessBlockFound(const CBlock& block, const CChainParams& chainparams);
 
@@ -2384,6 +2384,12 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             return true;
         }
 
+        // Hash and check the proof of work of the whole batch in parallel and
+        // outside of cs_main. The result is ignored here: the hashes are
+        // memoized in the headers and ProcessNewBlockHeaders reports an invalid
+        // header in order, with the right DoS score.
+        CheckBlockHeadersPoW(headers, chainparams.GetConsensus());
+
         const CBlockIndex* pindexLast = NULL;
         {
             LOCK(cs_main);
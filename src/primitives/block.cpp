@@ -11,11 +11,91 @@
 #include "tinyformat.h"
 #include "utilstrencodings.h"
 
-uint256 CBlockHeader::GetHash() const
+#include <atomic>
+#include <mutex>
+
+#include <string.h>
+
+static_assert(sizeof(int32_t) + 2 * sizeof(uint256) + 3 * sizeof(uint32_t) == INPUT_BYTES, "block header must serialize to INPUT_BYTES");
+
+namespace
+{
+// Guards the memoized hash fields of every CBlockHeader. Blocks are shared between
+// the network and validation threads through std::shared_ptr<const CBlock>, so GetHash() may run
+// concurrently on the same object. Argon2d itself runs outside of this lock.
+std::mutex csBlockHashCache;
+std::atomic<uint64_t> nBlockHashCacheHits(0);
+std::atomic<uint64_t> nBlockHashCacheMisses(0);
+} // namespace
+
+BlockHashCacheStats GetBlockHashCacheStats()
+{
+    BlockHashCacheStats stats;
+    stats.nHits = nBlockHashCacheHits.load(std::memory_order_relaxed);
+    stats.nMisses = nBlockHashCacheMisses.load(std::memory_order_relaxed);
+    return stats;
+}
+
+CBlockHeader::CBlockHeader(const CBlockHeader& other) : fHashCached(false)
+{
+    *this = other;
+}
+
+CBlockHeader& CBlockHeader::operator=(const CBlockHeader& other)
+{
+    if (this == &other)
+        return *this;
+
+    nVersion = other.nVersion;
+    hashPrevBlock = other.hashPrevBlock;
+    hashMerkleRoot = other.hashMerkleRoot;
+    nTime = other.nTime;
+    nBits = other.nBits;
+    nNonce = other.nNonce;
+
+    std::lock_guard<std::mutex> lock(csBlockHashCache);
+    fHashCached = other.fHashCached;
+    if (fHashCached) {
+        memcpy(vchHashedHeader, other.vchHashedHeader, INPUT_BYTES);
+        hashCached = other.hashCached;
+    }
+    return *this;
+}
+
+uint256 CBlockHeader::ComputeHash() const
 {
     return hash_Argon2d(BEGIN(nVersion), END(nNonce), 1);
 }
 
+bool CBlockHeader::ComputeHashes(uint32_t nCount, uint256* phashes) const
+{
+    unsigned char vchHeader[INPUT_BYTES];
+    memcpy(vchHeader, BEGIN(nVersion), INPUT_BYTES);
+    return Argon2d_Phase1_HashNonces(vchHeader, nCount, phashes) == ARGON2_OK;
+}
+
+uint256 CBlockHeader::GetHash() const
+{
+    unsigned char vchHeader[INPUT_BYTES];
+    memcpy(vchHeader, BEGIN(nVersion), INPUT_BYTES);
+    {
+        std::lock_guard<std::mutex> lock(csBlockHashCache);
+        if (fHashCached && memcmp(vchHashedHeader, vchHeader, INPUT_BYTES) == 0) {
+            nBlockHashCacheHits.fetch_add(1, std::memory_order_relaxed);
+            return hashCached;
+        }
+    }
+    nBlockHashCacheMisses.fetch_add(1, std::memory_order_relaxed);
+
+    uint256 hash = hash_Argon2d(vchHeader, vchHeader + INPUT_BYTES, 1);
+
+    std::lock_guard<std::mutex> lock(csBlockHashCache);
+    memcpy(vchHashedHeader, vchHeader, INPUT_BYTES);
+    hashCached = hash;
+    fHashCached = true;
+    return hash;
+}
+
 std::string CBlock::ToString() const
 {
     std::stringstream s;
@@ -12,6 +12,16 @@
 #include "uint256.h"
 #include "utilstrencodings.h"
 
+#include <stdint.h>
+
+/** Hit and miss counters of the memoized block header hash. */
+struct BlockHashCacheStats {
+    uint64_t nHits;
+    uint64_t nMisses;
+};
+
+BlockHashCacheStats GetBlockHashCacheStats();
+
 /** Nodes collect new transactions into a block, hash them into a hash tree,
  * and scan through nonce values to make the block's hash satisfy proof-of-work
  * requirements.  When they solve the proof-of-work, they broadcast the block
@@ -30,11 +40,24 @@ public:
     uint32_t nBits;
     uint32_t nNonce;
 
+private:
+    // memory only: last Argon2d hash and the serialized header it was computed from.
+    // The header fields are public and written directly all over the code base, so
+    // the cache is keyed on the header bytes instead of being reset by setters.
+    mutable unsigned char vchHashedHeader[INPUT_BYTES];
+    mutable uint256 hashCached;
+    mutable bool fHashCached;
+
+public:
     CBlockHeader()
     {
         SetNull();
     }
 
+    // copies take csBlockHashCache, the source may be hashed on another thread meanwhile
+    CBlockHeader(const CBlockHeader& other);
+    CBlockHeader& operator=(const CBlockHeader& other);
+
     ADD_SERIALIZE_METHODS;
 
     template <typename Stream, typename Operation>
@@ -56,6 +79,7 @@ public:
         nTime = 0;
         nBits = 0;
         nNonce = 0;
+        fHashCached = false;
     }
 
     bool IsNull() const
@@ -63,8 +87,16 @@ public:
         return (nBits == 0);
     }
 
+    /** Returns the Argon2d hash of the header, recomputing it only if a header field changed since the last call. */
     uint256 GetHash() const;
 
+    /** Always runs Argon2d over the header, bypassing the memoized hash. */
+    uint256 ComputeHash() const;
+
+    /** Hashes the header with nonces nNonce .. nNonce + nCount - 1 into phashes, for miners; bypasses the memoized hash.
+     *  Returns false if Argon2d failed, phashes is then not usable. */
+    bool ComputeHashes(uint32_t nCount, uint256* phashes) const;
+
     int64_t GetBlockTime() const
     {
         return (int64_t)nTime;
@@ -114,13 +146,8 @@ public:
 
     CBlockHeader GetBlockHeader() const
     {
-        CBlockHeader block;
-        block.nVersion = nVersion;
-        block.hashPrevBlock = hashPrevBlock;
-        block.hashMerkleRoot = hashMerkleRoot;
-        block.nTime = nTime;
-        block.nBits = nBits;
-        block.nNonce = nNonce;
+        // slice copy so the memoized hash travels with the header
+        CBlockHeader block = *this;
         return block;
     }
 
@@ -1167,6 +1167,10 @@ UniValue getblockchaininfo(const JSONRPCRequest& request)
             "  \"chainwork\": \"xxxx\"     (string) total amount of work in active chain, in hexadecimal\n"
             "  \"pruned\": xx,             (boolean) if the blocks are subject to pruning\n"
             "  \"pruneheight\": xxxxxx,    (numeric) lowest-height complete block stored\n"
+            "  \"blockhashcache\": {      (object) memoized Argon2d block header hashes\n"
+            "     \"hits\": xxxxxx,        (numeric) number of GetHash() calls answered from the cache\n"
+            "     \"misses\": xxxxxx       (numeric) number of GetHash() calls that ran Argon2d\n"
+            "  },\n"
             "  \"softforks\": [            (array) status of softforks in progress\n"
             "     {\n"
             "        \"id\": \"xxxx\",        (string) name of softfork\n"
@@ -1203,6 +1207,12 @@ UniValue getblockchaininfo(const JSONRPCRequest& request)
     obj.push_back(Pair("chainwork", chainActive.Tip()->nChainWork.GetHex()));
     obj.push_back(Pair("pruned", fPruneMode));
 
+    BlockHashCacheStats hashCacheStats = GetBlockHashCacheStats();
+    UniValue hashcache(UniValue::VOBJ);
+    hashcache.push_back(Pair("hits", hashCacheStats.nHits));
+    hashcache.push_back(Pair("misses", hashCacheStats.nMisses));
+    obj.push_back(Pair("blockhashcache", hashcache));
+
     const Consensus::Params& consensusParams = Params().GetConsensus();
     CBlockIndex* tip = chainActive.Tip();
     UniValue softforks(UniValue::VARR);
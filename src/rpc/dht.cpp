@@ -67,7 +67,7 @@ static UniValue GetMutable(const JSONRPCRequest& request)
     std::array<char, 32> pubKey;
     libtorrent::aux::from_hex(strPubKey, pubKey.data());
     bool fAuthoritative;
-    fRet = DHT::SubmitGet(0, pubKey, strSalt, 2000, strValue, iSequence, fAuthoritative);
+    fRet = DHT::SubmitGet(pubKey, strSalt, 2000, strValue, iSequence, fAuthoritative);
     if (fRet) {
         result.push_back(Pair("Public Key", strPubKey));
         result.push_back(Pair("Salt", strSalt));
@@ -141,7 +141,7 @@ static UniValue PutMutable(const JSONRPCRequest& request)
     if (!fNewEntry) {
         std::string strGetLastValue;
         // we need the last sequence number to update an existing DHT entry.
-        DHT::SubmitGet(0, pubKey, strOperationType, 2000, strGetLastValue, iSequence, fAuthoritative);
+        DHT::SubmitGet(pubKey, strOperationType, 2000, strGetLastValue, iSequence, fAuthoritative);
         iSequence++;
     }
     uint16_t nTotalSlots = 32;
@@ -190,6 +190,21 @@ static UniValue GetDHTStatus(const JSONRPCRequest& request)
             "  \"total_ip_overhead_upload\"      (int)      Total torrent IP overhead for uploads\n"
             "  \"total_payload_download\"        (int)      Total torrent payload for downloads\n"
             "  \"total_payload_upload\"          (int)      Total torrent payload for uploads\n"
+            "  \"storage_cache_hits\"            (int)      Mutable item gets served from memory\n"
+            "  \"storage_cache_misses\"          (int)      Mutable item gets that read the database\n"
+            "  \"storage_cache_evictions\"       (int)      Mutable items evicted from memory\n"
+            "  \"storage_cache_entries\"         (int)      Mutable items held in memory\n"
+            "  \"storage_cache_bytes\"           (int)      Estimated memory used by cached mutable items\n"
+            "  \"session_queues\"                (array)    Pending gets and puts for each DHT session\n"
+            "  \"reannounce_round\"              (int)      Number of the current reannounce round\n"
+            "  \"reannounce_round_start\"        (int)      Time the current reannounce round started\n"
+            "  \"reannounce_round_items\"        (int)      Local items to check this round\n"
+            "  \"reannounce_round_checked\"      (int)      Local items checked so far this round\n"
+            "  \"reannounce_round_replicated\"   (int)      Checked items the DHT already returned at the current sequence\n"
+            "  \"reannounce_round_reannounced\"  (int)      Checked items reannounced this round\n"
+            "  \"reannounce_last_round_seconds\" (int)      Duration of the last finished round\n"
+            "  \"reannounce_total\"              (int)      Items reannounced since startup\n"
+            "  \"reannounce_invalid\"            (int)      Stored items skipped for an invalid signature since startup\n"
             "  \"dht_nodes\"                     (int)      Number of DHT nodes\n"
             "  {(dht_bucket)\n"
             "    \"num_nodes\"                   (int)      Number of nodes in DHT bucket\n"
@@ -225,6 +240,30 @@ static UniValue GetDHTStatus(const JSONRPCRequest& request)
     result.push_back(Pair("get_pieces", stats.nGetPieces));
     result.push_back(Pair("get_bytes", stats.nGetBytes));
     result.push_back(Pair("get_errors", stats.nGetErrors));
+    result.push_back(Pair("storage_cache_hits", stats.nCacheHits));
+    result.push_back(Pair("storage_cache_misses", stats.nCacheMisses));
+    result.push_back(Pair("storage_cache_evictions", stats.nCacheEvictions));
+    result.push_back(Pair("storage_cache_entries", stats.nCacheEntries));
+    result.push_back(Pair("storage_cache_bytes", stats.nCacheBytes));
+
+    UniValue oQueues(UniValue::VARR);
+    for (unsigned int i = 0; i < stats.vQueueDepths.size(); i++) {
+        UniValue oQueue(UniValue::VOBJ);
+        oQueue.push_back(Pair("session", (int)i));
+        oQueue.push_back(Pair("pending_gets", stats.vQueueDepths[i].first));
+        oQueue.push_back(Pair("pending_puts", stats.vQueueDepths[i].second));
+        oQueues.push_back(oQueue);
+    }
+    result.push_back(Pair("session_queues", oQueues));
+    result.push_back(Pair("reannounce_round", stats.reannounce.nRound));
+    result.push_back(Pair("reannounce_round_start", stats.reannounce.nRoundStart));
+    result.push_back(Pair("reannounce_round_items", stats.reannounce.nRoundItems));
+    result.push_back(Pair("reannounce_round_checked", stats.reannounce.nRoundChecked));
+    result.push_back(Pair("reannounce_round_replicated", stats.reannounce.nRoundReplicated));
+    result.push_back(Pair("reannounce_round_reannounced", stats.reannounce.nRoundReannounced));
+    result.push_back(Pair("reannounce_last_round_seconds", stats.reannounce.nLastRoundSeconds));
+    result.push_back(Pair("reannounce_total", stats.reannounce.nTotalReannounced));
+    result.push_back(Pair("reannounce_invalid", stats.reannounce.nTotalInvalid));
 
     for (const std::pair<std::string, std::string>& pairMessage : stats.vMessages)
     {
@@ -234,12 +273,17 @@ static UniValue GetDHTStatus(const JSONRPCRequest& request)
     return result;
 }
 
+static const int DEFAULT_DHTDB_PAGE_SIZE = 1000;
+
 UniValue dhtdb(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() != 0)
+    if (request.fHelp || request.params.size() > 2)
         throw std::runtime_error(
-            "dhtdb"
-            "\nGets the local DHT cache database contents.\n"
+            "dhtdb ( limit \"start_info_hash\" )\n"
+            "\nGets the local DHT cache database contents, one page at a time.\n"
+            "\nArguments:\n"
+            "1. limit                  (int, optional)    Maximum number of entries to return (default: " + std::to_string(DEFAULT_DHTDB_PAGE_SIZE) + ", 0 for all)\n"
+            "2. start_info_hash        (string, optional) Info hash to start listing from, use next_info_hash from the previous page\n"
             "\nResult:\n"
             "{(json object)\n"
             "  \"info_hash\"                  (string)      Mutable data info hash\n"
@@ -248,17 +292,36 @@ UniValue dhtdb(const JSONRPCRequest& request)
             "  \"seq_num\"                    (int)         Mutable data sequsence number\n"
             "  \"salt\"                       (string)      Mutable data entry salt or operation code\n"
             "  \"value\"                      (string)      Mutable data entry value\n"
+            "  \"summary\" {\n"
+            "    \"record_count\"             (int)         Number of entries returned\n"
+            "    \"next_info_hash\"           (string)      Start of the next page, only present when more entries remain\n"
+            "  }\n"
             "  }\n"
             "\nExamples\n" +
            HelpExampleCli("dhtdb", "") +
+           HelpExampleCli("dhtdb", "100 \"f1e2f2cf3a3e4c0b5a3d8e0c4b5a8f7e6d5c4b3a\"") +
            "\nAs a JSON-RPC call\n" + 
-           HelpExampleRpc("dhtdb", ""));
+           HelpExampleRpc("dhtdb", "100, \"f1e2f2cf3a3e4c0b5a3d8e0c4b5a8f7e6d5c4b3a\""));
+
+    int nLimit = DEFAULT_DHTDB_PAGE_SIZE;
+    if (request.params.size() > 0)
+        nLimit = request.params[0].get_int();
+    if (nLimit < 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "limit can not be negative");
+
+    std::vector<unsigned char> vchStartInfoHash;
+    if (request.params.size() > 1) {
+        const std::string strStartInfoHash = request.params[1].get_str();
+        if (strStartInfoHash.size() != 40 || !IsHex(strStartInfoHash))
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "start_info_hash must be a 40 character hex string");
+        vchStartInfoHash = ParseHex(strStartInfoHash);
+    }
 
     UniValue result(UniValue::VOBJ);
 
     std::vector<CMutableData> vchMutableData;
-    
-    bool fRet = GetAllLocalMutableData(vchMutableData);
+    std::vector<unsigned char> vchNextInfoHash;
+    bool fRet = GetLocalMutableDataPage(vchStartInfoHash, (size_t)nLimit, vchMutableData, vchNextInfoHash);
     int nCounter = 0;
     if (fRet) {
         for(const CMutableData& data : vchMutableData) {
@@ -278,6 +341,8 @@ UniValue dhtdb(const JSONRPCRequest& request)
     }
     UniValue oCounter(UniValue::VOBJ);
     oCounter.push_back(Pair("record_count", nCounter));
+    if (!vchNextInfoHash.empty())
+        oCounter.push_back(Pair("next_info_hash", HexStr(vchNextInfoHash)));
     result.push_back(Pair("summary", oCounter));
     return result;
 }
@@ -352,7 +417,7 @@ static UniValue PutRecord(const JSONRPCRequest& request)
     std::string strHeaderHex;
     std::string strHeaderSalt = strOperationType + ":" + std::to_string(0);
     // we need the last sequence number to update an existing DHT entry. 
-    DHT::SubmitGet(0, getKey.GetDHTPubKey(), strHeaderSalt, 2000, strHeaderHex, iSequence, fAuthoritative);
+    DHT::SubmitGet(getKey.GetDHTPubKey(), strHeaderSalt, 2000, strHeaderHex, iSequence, fAuthoritative);
     CRecordHeader header(strHeaderHex);
     if (header.nUnlockTime  > GetTime())
         throw JSONRPCError(RPC_DHT_RECORD_LOCKED, strprintf("DHT data entry is locked for another %lli seconds", (header.nUnlockTime  - GetTime())));
@@ -455,7 +520,7 @@ static UniValue ClearRecord(const JSONRPCRequest& request)
     std::string strHeaderHex;
     std::string strHeaderSalt = strOperationType + ":" + std::to_string(0);
     // we need the last sequence number to update an existing DHT entry. 
-    DHT::SubmitGet(0, getKey.GetDHTPubKey(), strHeaderSalt, 2000, strHeaderHex, iSequence, fAuthoritative);
+    DHT::SubmitGet(getKey.GetDHTPubKey(), strHeaderSalt, 2000, strHeaderHex, iSequence, fAuthoritative);
     CRecordHeader header(strHeaderHex);
 
     if (header.nUnlockTime  > GetTime())
@@ -543,7 +608,7 @@ static UniValue GetRecord(const JSONRPCRequest& request)
     std::array<char, 32> arrPubKey;
     libtorrent::aux::from_hex(strPubKey, arrPubKey.data());
     CDataRecord record;
-    if (!DHT::SubmitGetRecord(0, arrPubKey, getKey.GetDHTPrivSeed(), strOperationType, iSequence, record))
+    if (!DHT::SubmitGetRecord(arrPubKey, getKey.GetDHTPrivSeed(), strOperationType, iSequence, record))
         throw JSONRPCError(RPC_DHT_GET_FAILED, strprintf("Failed to get record"));
 
     result.push_back(Pair("get_seq", iSequence));
@@ -642,7 +707,7 @@ UniValue dhtgetmessages(const JSONRPCRequest& request)
     UniValue result(UniValue::VOBJ);
 
     std::vector<CMutableGetEvent> vchMutableData;
-    bool fRet = DHT::GetAllDHTGetEvents(0, vchMutableData);
+    bool fRet = DHT::GetAllDHTGetEvents(vchMutableData);
     int nCounter = 0;
     if (fRet) {
         for(const CMutableGetEvent& data : vchMutableData) {
@@ -770,7 +835,7 @@ static UniValue GetLinkRecord(const JSONRPCRequest& request)
     std::array<char, 32> arrPubKey;
     libtorrent::aux::from_hex(strPubKey, arrPubKey.data());
     CDataRecord record;
-    if (!DHT::SubmitGetRecord(0, arrPubKey, getKey.GetDHTPrivSeed(), strOperationType, iSequence, record))
+    if (!DHT::SubmitGetRecord(arrPubKey, getKey.GetDHTPrivSeed(), strOperationType, iSequence, record))
         throw JSONRPCError(RPC_DHT_GET_FAILED, strprintf("Failed to get record"));
 
     result.push_back(Pair("get_seq", iSequence));
@@ -848,7 +913,7 @@ static UniValue GetAllLinkRecords(const JSONRPCRequest& request)
     }
 
     std::vector<CDataRecord> vchRecords;
-    if (!DHT::SubmitGetAllRecordsSync(0, vchLinkInfo, strOperationType, vchRecords))
+    if (!DHT::SubmitGetAllRecordsSync(vchLinkInfo, strOperationType, vchRecords))
         throw JSONRPCError(RPC_DHT_GET_FAILED, strprintf("Failed to get records"));
 
     int nRecordItem = 1;
@@ -963,7 +1028,7 @@ static UniValue PutLinkRecord(const JSONRPCRequest& request)
 
     // we need the last sequence number to update an existing DHT entry.
     std::string strHeaderSalt = strOperationType + ":" + std::to_string(0);
-    DHT::SubmitGet(0, getKey.GetDHTPubKey(), strHeaderSalt, 2000, strHeaderHex, iSequence, fAuthoritative);
+    DHT::SubmitGet(getKey.GetDHTPubKey(), strHeaderSalt, 2000, strHeaderHex, iSequence, fAuthoritative);
     CRecordHeader header(strHeaderHex);
     if (header.nUnlockTime  > GetTime())
         throw JSONRPCError(RPC_DHT_RECORD_LOCKED, strprintf("DHT data entry is locked for another %lli seconds", (header.nUnlockTime  - GetTime())));
@@ -1091,7 +1156,7 @@ static UniValue ClearLinkRecord(const JSONRPCRequest& request)
 
     // we need the last sequence number to update an existing DHT entry.
     std::string strHeaderSalt = strOperationType + ":" + std::to_string(0);
-    DHT::SubmitGet(0, getKey.GetDHTPubKey(), strHeaderSalt, 2000, strHeaderHex, iSequence, fAuthoritative);
+    DHT::SubmitGet(getKey.GetDHTPubKey(), strHeaderSalt, 2000, strHeaderHex, iSequence, fAuthoritative);
     CRecordHeader header(strHeaderHex);
 
     if (header.nUnlockTime  > GetTime())
@@ -1142,7 +1207,9 @@ static UniValue ReannounceLocalMutable(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_BDAP_DB_ERROR, strprintf("Can not access mutable data item database."));
 
     std::string strInfoHash = request.params[1].get_str();
-    CharString vchInfoHash = vchFromString(strInfoHash);
+    if (strInfoHash.size() != 40 || !IsHex(strInfoHash))
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid mutable data infohash %s, expected 40 hex characters.", strInfoHash));
+    CharString vchInfoHash = ParseHex(strInfoHash);
 
     UniValue result(UniValue::VOBJ);
 
@@ -1279,7 +1346,7 @@ static const CRPCCommand commands[] =
   //  --------------------- ------------------------ -----------------------        ------   --------------------
     /* DHT */
     { "dht",             "dht",                      &dht_rpc,                      true,    {"command", "param1", "param2", "param3"}  },
-    { "dht",             "dhtdb",                    &dhtdb,                        true,    {} },
+    { "dht",             "dhtdb",                    &dhtdb,                        true,    {"limit", "start_info_hash"} },
     { "dht",             "dhtputmessages",           &dhtputmessages,               true,    {} },
     { "dht",             "dhtgetmessages",           &dhtgetmessages,               true,    {} },
 };
@@ -202,8 +202,8 @@ UniValue getusers(const JSONRPCRequest& request)
             "getusers \"search string\" \"records per page\" \"page returned\"\n"
             "\nArguments:\n"
             "1. search string        (string, optional)  Search for userid\n"
-            "2. records per page     (int, optional)  If paging, the number of records per page\n"
-            "3. page returned        (int, optional)  If paging, the page number to return\n"
+            "2. records per page     (int, optional, default=100)  The number of records per page, given together with page returned\n"
+            "3. page returned        (int, optional, default=1)  The page number to return, without paging arguments only the first 100 records are returned\n"
             "\nLists all BDAP user accounts in the \"public\" OU for the \"bdap.io\" domain.\n"
             "\nResult:\n"
             "{(json objects)\n"
@@ -261,8 +261,8 @@ UniValue getgroups(const JSONRPCRequest& request)
             "getgroups \"search string\" \"records per page\" \"page returned\"\n"
             "\nArguments:\n"
             "1. search string        (string, optional)  Search for userid\n"
-            "2. records per page     (int, optional)  If paging, the number of records per page\n"
-            "3. page returned        (int, optional)  If paging, the page number to return\n"
+            "2. records per page     (int, optional, default=100)  The number of records per page, given together with page returned\n"
+            "3. page returned        (int, optional, default=1)  The page number to return, without paging arguments only the first 100 records are returned\n"
             "\nLists all BDAP group accounts in the \"public\" OU for the \"bdap.io\" domain.\n"
             "\nResult:\n"
             "{(json objects)\n"
@@ -780,6 +780,51 @@ UniValue deletegroup(const JSONRPCRequest& request)
     return DeleteDomainEntry(request, bdapType);
 }
 
+static void PushCacheStats(UniValue& result, const std::string& strName, const CLRUCacheStats& stats)
+{
+    result.push_back(Pair(strName + "_hits", stats.nHits));
+    result.push_back(Pair(strName + "_misses", stats.nMisses));
+    result.push_back(Pair(strName + "_evictions", stats.nEvictions));
+    result.push_back(Pair(strName + "_entries", (uint64_t)stats.nEntries));
+    result.push_back(Pair(strName + "_bytes", (uint64_t)stats.nBytes));
+    result.push_back(Pair(strName + "_max_bytes", (uint64_t)stats.nMaxBytes));
+}
+
+UniValue bdapcacheinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "bdapcacheinfo\n"
+            "\nShows the in-memory BDAP account cache statistics.\n"
+            "\nResult:\n"
+            "{(json object)\n"
+            "  \"entry_cache_hits\"          (int)  Lookups by object path served from memory\n"
+            "  \"entry_cache_misses\"        (int)  Lookups by object path that read the database\n"
+            "  \"entry_cache_evictions\"     (int)  Object path lookups evicted from memory\n"
+            "  \"entry_cache_entries\"       (int)  Object path lookups held in memory\n"
+            "  \"entry_cache_bytes\"         (int)  Estimated memory used by object path lookups\n"
+            "  \"entry_cache_max_bytes\"     (int)  Memory limit for object path lookups\n"
+            "  \"pubkey_cache_hits\"         (int)  Lookups by DHT public key served from memory\n"
+            "  \"pubkey_cache_misses\"       (int)  Lookups by DHT public key that read the database\n"
+            "  \"pubkey_cache_evictions\"    (int)  DHT public key lookups evicted from memory\n"
+            "  \"pubkey_cache_entries\"      (int)  DHT public key lookups held in memory\n"
+            "  \"pubkey_cache_bytes\"        (int)  Estimated memory used by DHT public key lookups\n"
+            "  \"pubkey_cache_max_bytes\"    (int)  Memory limit for DHT public key lookups\n"
+            "  }\n"
+            "\nExamples\n" +
+           HelpExampleCli("bdapcacheinfo", "") +
+           "\nAs a JSON-RPC call\n" + 
+           HelpExampleRpc("bdapcacheinfo", ""));
+
+    if (!CheckDomainEntryDB())
+        throw std::runtime_error("BDAP_CACHE_INFO_RPC_ERROR: ERRCODE: 3900 - " + _("Can not access BDAP LevelDB database!"));
+
+    UniValue result(UniValue::VOBJ);
+    PushCacheStats(result, "entry_cache", pDomainEntryDB->GetEntryCacheStats());
+    PushCacheStats(result, "pubkey_cache", pDomainEntryDB->GetPubKeyCacheStats());
+    return result;
+}
+
 UniValue makekeypair(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() > 1)
@@ -1229,6 +1274,7 @@ static const CRPCCommand commands[] =
     { "bdap",            "bdapfees",                 &bdapfees,                     true, {} },
 #endif //ENABLE_WALLET
     { "bdap",            "makekeypair",              &makekeypair,                  true, {"prefix"} },
+    { "bdap",            "bdapcacheinfo",            &bdapcacheinfo,                true, {} },
 };
 
 void RegisterDomainEntryRPCCommands(CRPCTable &t)
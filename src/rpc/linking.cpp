@@ -896,7 +896,7 @@ static UniValue DenyLink(const JSONRPCRequest& request)
     int64_t iSequence = 0;
     bool fNotFound = false;
     CDataRecord record;
-    if (!DHT::SubmitGetRecord(0, getKey.GetDHTPubKey(), getKey.GetDHTPrivSeed(), strOperationType, iSequence, record))
+    if (!DHT::SubmitGetRecord(getKey.GetDHTPubKey(), getKey.GetDHTPrivSeed(), strOperationType, iSequence, record))
         fNotFound = true;
 
     std::vector<unsigned char> vchSerializedList;
@@ -983,7 +983,7 @@ static UniValue DeniedLinkList(const JSONRPCRequest& request)
     std::string strOperationType = "denylink";
     int64_t iSequence = 0;
     CDataRecord record;
-    if (!DHT::SubmitGetRecord(0, getKey.GetDHTPubKey(), getKey.GetDHTPrivSeed(), strOperationType, iSequence, record)) {
+    if (!DHT::SubmitGetRecord(getKey.GetDHTPubKey(), getKey.GetDHTPrivSeed(), strOperationType, iSequence, record)) {
         // return empty JSON 
         UniValue oDeniedLink(UniValue::VOBJ);
         oLink.push_back(Pair("denied_list", oDeniedLink));
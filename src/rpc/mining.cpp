@@ -14,10 +14,12 @@
 #include "consensus/params.h"
 #include "consensus/validation.h"
 #include "core_io.h"
+#include "crypto/argon2d/arena.h"
 #include "fluid/fluid.h"
 #include "fluid/fluiddb.h"
 #include "fluid/fluidmint.h"
 #include "init.h"
+#include "miner/internal/miners-controller.h"
 #include "miner/miner.h"
 #include "net.h"
 #include "pow.h"
@@ -400,6 +402,78 @@ UniValue getgpuhashespersec(const JSONRPCRequest& request)
     return GetGPUHashRate();
 }
 
+static UniValue MinerLatencyToJSON(const MinerLatency& latency)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("last_ms", latency.last() / 1000.0));
+    obj.push_back(Pair("average_ms", latency.average() / 1000.0));
+    obj.push_back(Pair("count", latency.count()));
+    return obj;
+}
+
+template <class T>
+static void MinerDevicesToJSON(UniValue& devices, const MinersThreadGroup<T>& group, const std::string& name)
+{
+    for (size_t index = 0; index < group.devices().size(); index++) {
+        const HashRateCounterRef& counter = group.devices()[index]->counter;
+        UniValue device(UniValue::VOBJ);
+        device.push_back(Pair("device", name));
+        device.push_back(Pair("index", (uint64_t)index));
+        device.push_back(Pair("hashespersec_1s", counter->GetRate(1)));
+        device.push_back(Pair("hashespersec_1m", counter->GetRate(60)));
+        device.push_back(Pair("hashespersec_15m", counter->GetRate(15 * 60)));
+        devices.push_back(device);
+    }
+}
+
+UniValue getminingstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getminingstats\n"
+            "\nReturns telemetry of the internal CPU and GPU miners since they were started."
+            "\nResult:\n"
+            "{\n"
+            "  \"devices\": [               (array) Hash rate of every mining device\n"
+            "    {\n"
+            "      \"device\": \"xxxx\",       (string) CPU or GPU\n"
+            "      \"index\": n,              (numeric) The device index\n"
+            "      \"hashespersec_1s\": n,    (numeric) Hashes per second over the last second\n"
+            "      \"hashespersec_1m\": n,    (numeric) Hashes per second over the last minute\n"
+            "      \"hashespersec_15m\": n    (numeric) Hashes per second over the last 15 minutes\n"
+            "    }, ...\n"
+            "  ],\n"
+            "  \"blocksfound\": n,          (numeric) Blocks found by the miners\n"
+            "  \"blocksaccepted\": n,       (numeric) Found blocks accepted by validation\n"
+            "  \"blocksstale\": n,          (numeric) Found blocks built on a tip that was already replaced\n"
+            "  \"tiptotemplate\": {...},    (object) Time from a new tip to a block template on it (last_ms, average_ms, count)\n"
+            "  \"templatetohash\": {...},   (object) Time from that template to the first miner hashing it\n"
+            "  \"argon2dhash\": {...}       (object) Argon2d time per hash on CPU miners\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getminingstats", "") + HelpExampleRpc("getminingstats", ""));
+
+    if (!gMiners)
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Miners are not initialized");
+
+    UniValue devices(UniValue::VARR);
+    MinerDevicesToJSON(devices, gMiners->group_cpu(), "CPU");
+#ifdef ENABLE_GPU
+    MinerDevicesToJSON(devices, gMiners->group_gpu(), "GPU");
+#endif // ENABLE_GPU
+
+    const MinerStats& stats = gMiners->stats();
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("devices", devices));
+    obj.push_back(Pair("blocksfound", stats.found()));
+    obj.push_back(Pair("blocksaccepted", stats.accepted()));
+    obj.push_back(Pair("blocksstale", stats.stale()));
+    obj.push_back(Pair("tiptotemplate", MinerLatencyToJSON(stats.tip_to_template)));
+    obj.push_back(Pair("templatetohash", MinerLatencyToJSON(stats.template_to_hash)));
+    obj.push_back(Pair("argon2dhash", MinerLatencyToJSON(stats.hash_time)));
+    return obj;
+}
+
 UniValue getmininginfo(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 0)
@@ -420,6 +494,12 @@ UniValue getmininginfo(const JSONRPCRequest& request)
             "  \"hashespersec\": n          (numeric) The recent hashes per second when generation is on (will return 0 if generation is off)\n"
             "  \"cpuhashespersec\": n       (numeric) The recent CPU hashes per second when generation is on (will return 0 if generation is off)\n"
             "  \"gpuhashespersec\": n       (numeric) The recent GPU hashes per second when generation is on (will return 0 if generation is off)\n"
+            "  \"argon2darena\": {           (object) Argon2d working memory reused per thread, since startup\n"
+            "    \"maps\": n,                (numeric) Mappings created on first use or growth\n"
+            "    \"reuses\": n,              (numeric) Hashes served from an existing mapping\n"
+            "    \"hugepages\": n,           (numeric) Mappings backed by huge pages\n"
+            "    \"fallbacks\": n            (numeric) Nested allocations served by malloc\n"
+            "  }\n"
             "}\n"
             "\nExamples:\n" +
             HelpExampleCli("getmininginfo", "") + HelpExampleRpc("getmininginfo", ""));
@@ -442,6 +522,14 @@ UniValue getmininginfo(const JSONRPCRequest& request)
     obj.push_back(Pair("hashespersec", gethashespersec(request)));
     obj.push_back(Pair("cpuhashespersec", getcpuhashespersec(request)));
     obj.push_back(Pair("gpuhashespersec", getgpuhashespersec(request)));
+
+    const Argon2dArenaStats arenaStats = GetArgon2dArenaStats();
+    UniValue arena(UniValue::VOBJ);
+    arena.push_back(Pair("maps", arenaStats.nMaps));
+    arena.push_back(Pair("reuses", arenaStats.nReuses));
+    arena.push_back(Pair("hugepages", arenaStats.nHugePages));
+    arena.push_back(Pair("fallbacks", arenaStats.nFallbacks));
+    obj.push_back(Pair("argon2darena", arena));
     return obj;
 }
 
@@ -1136,6 +1224,7 @@ static const CRPCCommand commands[] =
         //  --------------------- ------------------------  -----------------------  ------ ---
         {"mining", "getnetworkhashps", &getnetworkhashps, true, {"nblocks", "height"}},
         {"mining", "getmininginfo", &getmininginfo, true, {}},
+        {"mining", "getminingstats", &getminingstats, true, {}},
         {"mining", "prioritisetransaction", &prioritisetransaction, true, {"txid", "priority_delta", "fee_delta"}},
         {"mining", "getblocktemplate", &getblocktemplate, true, {"template_request"}},
         {"mining", "submitblock", &submitblock, true, {"hexdata", "parameters"}},
@@ -13,6 +13,8 @@
 #include "utilstrencodings.h"
 #include "test/test_dynamic.h"
 #include "bdap/linking.h"
+#include "bdap/linkmanager.h"
+#include "streams.h"
 
 
 #include <string>
@@ -43,4 +45,102 @@ BOOST_AUTO_TEST_CASE(bdap_link_test1)
 
 }
 
+static CLink MakeTestLink(const std::string& strRequestor, const std::string& strRecipient, uint8_t nState, bool fRequestFromMe)
+{
+    CLink link;
+    link.LinkID = GetLinkID(strRequestor, strRecipient);
+    link.nLinkState = nState;
+    link.fRequestFromMe = fRequestFromMe;
+    link.RequestorFullObjectPath = std::vector<unsigned char>(strRequestor.begin(), strRequestor.end());
+    link.RecipientFullObjectPath = std::vector<unsigned char>(strRecipient.begin(), strRecipient.end());
+    link.txHashRequest = Hash(link.LinkID.begin(), link.LinkID.end());
+    if (nState == 2)
+        link.txHashAccept = Hash(link.txHashRequest.begin(), link.txHashRequest.end());
+    return link;
+}
+
+BOOST_AUTO_TEST_CASE(bdap_link_manager_indexes)
+{
+    CLinkManager manager;
+    CLink pending = MakeTestLink("alice@public.bdap.io", "bob@public.bdap.io", 1, true);
+    CLink incoming = MakeTestLink("carol@public.bdap.io", "alice@public.bdap.io", 1, false);
+    CLink completed = MakeTestLink("alice@public.bdap.io", "dave@public.bdap.io", 2, true);
+    completed.SubjectID = Hash(completed.txHashAccept.begin(), completed.txHashAccept.end());
+    manager.LoadLinkRecord(pending);
+    manager.LoadLinkRecord(incoming);
+    manager.LoadLinkRecord(completed);
+
+    std::vector<CLink> vLinks;
+    BOOST_CHECK(manager.ListMyPendingRequests(vLinks));
+    BOOST_CHECK(vLinks.size() == 1 && vLinks[0].LinkID == pending.LinkID);
+    vLinks.clear();
+    BOOST_CHECK(manager.ListMyPendingAccepts(vLinks));
+    BOOST_CHECK(vLinks.size() == 1 && vLinks[0].LinkID == incoming.LinkID);
+    vLinks.clear();
+    BOOST_CHECK(manager.ListMyCompleted(vLinks));
+    BOOST_CHECK(vLinks.size() == 1 && vLinks[0].LinkID == completed.LinkID);
+
+    CLink found;
+    BOOST_CHECK(manager.FindLinkBySubjectID(completed.SubjectID, found));
+    BOOST_CHECK(found.LinkID == completed.LinkID);
+    BOOST_CHECK(!manager.FindLinkBySubjectID(pending.txHashRequest, found));
+
+    std::vector<CLinkInfo> vInfo = manager.GetCompletedLinkInfo(completed.RequestorFullObjectPath);
+    BOOST_CHECK(vInfo.size() == 1 && vInfo[0].vchFullObjectPath == completed.RecipientFullObjectPath);
+
+    // the accept arrives, the pending request moves to completed
+    pending.nLinkState = 2;
+    pending.txHashAccept = Hash(pending.txHashRequest.begin(), pending.txHashRequest.end());
+    manager.LoadLinkRecord(pending);
+    vLinks.clear();
+    BOOST_CHECK(manager.ListMyPendingRequests(vLinks) && vLinks.empty());
+    BOOST_CHECK(manager.GetCompletedLinkInfo(pending.RequestorFullObjectPath).size() == 2);
+    BOOST_CHECK(manager.LinkCount() == 3);
+    BOOST_CHECK(manager.GetLinkIDs().size() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(bdap_link_manager_subject_index)
+{
+    CLinkManager manager;
+    CLink first = MakeTestLink("alice@public.bdap.io", "bob@public.bdap.io", 2, true);
+    CLink second = MakeTestLink("alice@public.bdap.io", "carol@public.bdap.io", 2, true);
+    if (second.LinkID < first.LinkID)
+        std::swap(first, second);
+    uint256 subjectID = Hash(first.txHashAccept.begin(), first.txHashAccept.end());
+    first.SubjectID = subjectID;
+    second.SubjectID = subjectID;
+    manager.LoadLinkRecord(second);
+    manager.LoadLinkRecord(first);
+
+    CLink found;
+    BOOST_CHECK(manager.FindLinkBySubjectID(subjectID, found));
+    BOOST_CHECK(found.LinkID == first.LinkID);
+
+    // the lowest link moves to another subject, the next one takes over
+    first.SubjectID = Hash(second.txHashAccept.begin(), second.txHashAccept.end());
+    manager.LoadLinkRecord(first);
+    BOOST_CHECK(manager.FindLinkBySubjectID(subjectID, found));
+    BOOST_CHECK(found.LinkID == second.LinkID);
+    BOOST_CHECK(manager.FindLinkBySubjectID(first.SubjectID, found));
+    BOOST_CHECK(found.LinkID == first.LinkID);
+}
+
+BOOST_AUTO_TEST_CASE(bdap_link_record_serialization)
+{
+    CLink link = MakeTestLink("alice@public.bdap.io", "bob@public.bdap.io", 2, true);
+    link.LinkMessage = std::vector<unsigned char>(5, 'x');
+    link.nHeightAccept = 1000;
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << link;
+    CLink read;
+    ss >> read;
+    BOOST_CHECK(read == link);
+    BOOST_CHECK(read.LinkID == link.LinkID);
+    BOOST_CHECK(read.RecipientFullObjectPath == link.RecipientFullObjectPath);
+    BOOST_CHECK(read.LinkMessage == link.LinkMessage);
+    BOOST_CHECK(read.nHeightAccept == 1000);
+    BOOST_CHECK(read.fRequestFromMe && read.nLinkState == 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
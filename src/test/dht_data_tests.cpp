@@ -19,6 +19,12 @@
 #include "dht/datarecord.h"
 #include "dht/dataheader.h"
 #include "dht/datachunk.h"
+#include "dht/limits.h"
+#include "dht/lrucache.h"
+#include "dht/mutable.h"
+#include "dht/mutabledb.h"
+#include "dht/sessionevents.h"
+#include "streams.h"
 
 #include <string>
 #include <stdint.h>
@@ -68,4 +74,253 @@ BOOST_AUTO_TEST_CASE(dht_data_test1)
 
 }
 
+BOOST_AUTO_TEST_CASE(dht_lru_cache)
+{
+    // one shard with room for three 10 byte entries
+    CShardedLRUCache<int, std::string> cache(1, 30);
+    cache.Put(1, "one", 10);
+    cache.Put(2, "two", 10);
+    cache.Put(3, "three", 10);
+
+    std::string strValue;
+    BOOST_CHECK(cache.Get(1, strValue) && strValue == "one"); // 1 is now most recently used
+    cache.Put(4, "four", 10);
+    BOOST_CHECK(!cache.Get(2, strValue)); // least recently used entry evicted
+    BOOST_CHECK(cache.Get(1, strValue));
+
+    BOOST_CHECK(!cache.Insert(3, "tres", 10)); // insert keeps the cached value
+    BOOST_CHECK(cache.Get(3, strValue) && strValue == "three");
+    cache.Put(3, "tres", 10);
+    BOOST_CHECK(cache.Get(3, strValue) && strValue == "tres");
+
+    cache.Put(5, "too big", 31);
+    BOOST_CHECK(!cache.Get(5, strValue));
+
+    CLRUCacheStats stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.nEntries, 3U);
+    BOOST_CHECK_EQUAL(stats.nBytes, 30U);
+    BOOST_CHECK_EQUAL(stats.nEvictions, 1U);
+    BOOST_CHECK_EQUAL(stats.nHits, 4U);
+    BOOST_CHECK_EQUAL(stats.nMisses, 2U);
+
+    cache.SetMaxBytes(10);
+    BOOST_CHECK_EQUAL(cache.GetStats().nEntries, 1U);
+    BOOST_CHECK(cache.Get(3, strValue));
+
+    // a conditional put only replaces a cached value the predicate accepts
+    BOOST_CHECK(!cache.PutIf(3, "drei", 10, [](const std::string& strCached) { return strCached != "tres"; }));
+    BOOST_CHECK(cache.Get(3, strValue) && strValue == "tres");
+    BOOST_CHECK(cache.PutIf(3, "drei", 10, [](const std::string& strCached) { return strCached == "tres"; }));
+    BOOST_CHECK(cache.Get(3, strValue) && strValue == "drei");
+    BOOST_CHECK(cache.PutIf(6, "six", 10, [](const std::string&) { return false; }));
+    BOOST_CHECK(cache.Get(6, strValue) && strValue == "six");
+}
+
+BOOST_AUTO_TEST_CASE(dht_mutable_hex_upgrade)
+{
+    const std::string strInfoHash = "88196b9f8ca5f1dfb095bd48e18d97157f7a4435";
+    const std::string strPubKey = std::string(64, 'a');
+    const std::string strSignature = std::string(128, 'b');
+
+    // legacy records kept the info hash, public key and signature in hex under "ih" keys,
+    // their nVersion was never initialized so any value must be converted
+    CMutableData hexData(vchFromString(strInfoHash), vchFromString(strPubKey), vchFromString(strSignature), 7, vchFromString("pshare-filter"), vchFromString("value"));
+    hexData.nVersion = 1234567;
+    CMutableData badData(vchFromString("not hex"), vchFromString(strPubKey), vchFromString(strSignature), 1, vchFromString("pshare-filter"), vchFromString("value"));
+    badData.nVersion = 0;
+    CMutableDataDB db(1 << 20, true, false, false);
+    BOOST_CHECK(db.Write(std::make_pair(std::string("ih"), vchFromString(strInfoHash)), hexData));
+    BOOST_CHECK(db.Write(std::make_pair(std::string("ih"), vchFromString("not hex")), badData));
+    BOOST_CHECK(db.Upgrade());
+
+    CMutableData data;
+    BOOST_CHECK(db.ReadMutableData(ParseHex(strInfoHash), data));
+    BOOST_CHECK(!db.Exists(std::make_pair(std::string("ih"), vchFromString(strInfoHash))));
+    // a record that does not convert is kept rather than dropped
+    BOOST_CHECK(db.Exists(std::make_pair(std::string("ih"), vchFromString("not hex"))));
+    BOOST_CHECK_EQUAL(data.nVersion, CMutableData::CURRENT_VERSION);
+    BOOST_CHECK_EQUAL(data.vchInfoHash.size(), 20U);
+    BOOST_CHECK_EQUAL(data.vchPublicKey.size(), 32U);
+    BOOST_CHECK_EQUAL(data.vchSignature.size(), 64U);
+    BOOST_CHECK_EQUAL(data.InfoHash(), strInfoHash);
+    BOOST_CHECK_EQUAL(data.PublicKey(), strPubKey);
+    BOOST_CHECK_EQUAL(data.SequenceNumber, 7);
+
+    // binary records round trip unchanged whatever their version, and are smaller
+    data.nVersion = 1;
+    CDataStream ssBinary(SER_DISK, CLIENT_VERSION);
+    ssBinary << data;
+    BOOST_CHECK(ssBinary.size() + 116 == ::GetSerializeSize(hexData, SER_DISK, CLIENT_VERSION));
+    CMutableData binaryData;
+    ssBinary >> binaryData;
+    BOOST_CHECK(binaryData.vchInfoHash == data.vchInfoHash);
+    BOOST_CHECK(binaryData.vchSignature == data.vchSignature);
+    BOOST_CHECK(binaryData.Signature() == strSignature);
+}
+
+BOOST_AUTO_TEST_CASE(dht_ed25519_batch_verify)
+{
+    std::vector<unsigned char> vchMsg = MutableItemSignedBytes(vchFromString("5:hello"), 3, vchFromString("salt"));
+    BOOST_CHECK(vchMsg == vchFromString("4:salt4:salt3:seqi3e1:v5:hello"));
+    BOOST_CHECK(MutableItemSignedBytes(vchFromString("i1e"), 0, CharString()) == vchFromString("3:seqi0e1:vi1e"));
+
+    std::vector<CEd25519SignatureCheck> vChecks;
+    for (int i = 0; i < 40; i++) {
+        CKeyEd25519 key;
+        std::vector<unsigned char> vchItem = MutableItemSignedBytes(vchFromString("5:hello"), i, vchFromString("salt"));
+        std::vector<unsigned char> vchSig;
+        BOOST_CHECK(key.Sign(vchItem, vchSig));
+        vChecks.emplace_back(key.GetPubKeyBytes(), vchSig, vchItem);
+    }
+    // a repeated check and two bad signatures
+    vChecks.push_back(vChecks[5]);
+    vChecks[7].signature[0] ^= 1;
+    vChecks[31].vchMessage.back() ^= 1;
+
+    std::vector<bool> vValid;
+    BOOST_CHECK(!Ed25519VerifyBatch(vChecks, vValid));
+    BOOST_CHECK_EQUAL(vValid.size(), vChecks.size());
+    for (size_t i = 0; i < vChecks.size(); i++) {
+        BOOST_CHECK_EQUAL(vValid[i], i != 7 && i != 31);
+        BOOST_CHECK_EQUAL(vValid[i], Ed25519Verify(vChecks[i]));
+    }
+    vChecks.erase(vChecks.begin() + 31);
+    vChecks.erase(vChecks.begin() + 7);
+    BOOST_CHECK(Ed25519VerifyBatch(vChecks, vValid));
+}
+
+BOOST_AUTO_TEST_CASE(dht_get_request_wait)
+{
+    const std::string strPubKey = std::string(64, 'a');
+    CMutableGetEvent event;
+
+    // nothing found before the deadline
+    CMutableGetRequest request(GetTimeMillis());
+    BOOST_CHECK(!request.Wait(GetTimeMillis(), event));
+
+    // a value arrived but the traversal is still running, the newest value is returned as not authoritative
+    request.Update(CMutableGetEvent("", 0, 0, "", strPubKey, "chat:1", 3, "5:three", "", false));
+    request.Update(CMutableGetEvent("", 0, 0, "", strPubKey, "chat:1", 2, "3:two", "", false));
+    BOOST_CHECK(request.Wait(GetTimeMillis() + 10, event));
+    BOOST_CHECK_EQUAL(event.Value(), "5:three");
+    BOOST_CHECK_EQUAL(event.SequenceNumber(), 3);
+    BOOST_CHECK(!event.Authoritative());
+
+    // the authoritative alert completes the request unless an older value would replace a newer one
+    request.Complete(CMutableGetEvent("", 0, 0, "", strPubKey, "chat:1", 4, "4:four", "", true));
+    request.Complete(CMutableGetEvent("", 0, 0, "", strPubKey, "chat:1", 5, "4:five", "", true));
+    BOOST_CHECK(request.Wait(GetTimeMillis(), event));
+    BOOST_CHECK_EQUAL(event.SequenceNumber(), 4);
+    BOOST_CHECK(event.Authoritative());
+
+    CMutableGetRequest staleRequest(GetTimeMillis());
+    staleRequest.Update(CMutableGetEvent("", 0, 0, "", strPubKey, "chat:1", 3, "5:three", "", false));
+    staleRequest.Complete(CMutableGetEvent("", 0, 0, "", strPubKey, "chat:1", 1, "3:one", "", true));
+    BOOST_CHECK(staleRequest.Wait(GetTimeMillis(), event));
+    BOOST_CHECK_EQUAL(event.SequenceNumber(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(dht_check_salt)
+{
+    std::string strErrorMessage;
+    BOOST_CHECK(CheckSalt("pshare:48", 0, strErrorMessage));
+    BOOST_CHECK(strErrorMessage.empty());
+    BOOST_CHECK(CheckSalt("avatar:+4", 0, strErrorMessage));
+    BOOST_CHECK(!CheckSalt("avatar:5", 0, strErrorMessage));
+    BOOST_CHECK(strErrorMessage.find("too many slots") != std::string::npos);
+    // only the matching salt's limit applies, not those of the salts sorted after it
+    BOOST_CHECK(!CheckSalt("avatar:10", 0, strErrorMessage));
+    BOOST_CHECK(strErrorMessage.find("Max slots = 4") != std::string::npos);
+    BOOST_CHECK(strErrorMessage.find("Max slots = 32") == std::string::npos);
+    BOOST_CHECK(!CheckSalt("test:9", 0, strErrorMessage));
+    BOOST_CHECK(CheckSalt("test:8", 0, strErrorMessage));
+    BOOST_CHECK(!CheckSalt("pshare", 0, strErrorMessage));
+    BOOST_CHECK(!CheckSalt("pshare:1:2", 0, strErrorMessage));
+    BOOST_CHECK(!CheckSalt("pshare:", 0, strErrorMessage));
+    BOOST_CHECK(!CheckSalt("pshare:-1", 0, strErrorMessage));
+    BOOST_CHECK(!CheckSalt("pshare:4294967296", 0, strErrorMessage));
+    // operation codes must match exactly, not by prefix
+    BOOST_CHECK(!CheckSalt("psha:1", 0, strErrorMessage));
+    BOOST_CHECK(!CheckSalt("pshares:1", 0, strErrorMessage));
+    BOOST_CHECK(strErrorMessage.find("salt not found") != std::string::npos);
+
+    const std::string strSalt = "chat:3";
+    BOOST_CHECK(CheckSalt(strSalt.data(), strSalt.size(), 0, strErrorMessage));
+}
+
+BOOST_AUTO_TEST_CASE(dht_mutable_data_view)
+{
+    const std::string strInfoHash(20, 'i'), strPubKey(32, 'p'), strSig(64, 's'), strSalt = "chat:1", strValue = "5:hello";
+    CMutableDataView view(strInfoHash.data(), strPubKey.data(), strSig.data(), 300, strSalt.data(), strSalt.size(), strValue.data(), strValue.size());
+    CMutableData data(vchFromString(strInfoHash), vchFromString(strPubKey), vchFromString(strSig), 300, vchFromString(strSalt), vchFromString(strValue));
+
+    // the view writes exactly what CMutableData would
+    CDataStream ssView(SER_DISK, CLIENT_VERSION), ssData(SER_DISK, CLIENT_VERSION);
+    ssView << view;
+    ssData << data;
+    BOOST_CHECK(std::string(ssView.begin(), ssView.end()) == std::string(ssData.begin(), ssData.end()));
+
+    CMutableDataSequence sequence;
+    ssView >> sequence;
+    BOOST_CHECK_EQUAL(sequence.nVersion, CMutableData::CURRENT_VERSION);
+    BOOST_CHECK_EQUAL(sequence.SequenceNumber, 300);
+
+    CMutableDataDB db(1 << 20, true, false, false);
+    bool fStored = false;
+    BOOST_CHECK(db.PutMutableDataIfNewer(data.vchInfoHash, view, fStored));
+    BOOST_CHECK(fStored);
+    BOOST_CHECK(db.PutMutableDataIfNewer(data.vchInfoHash, view, fStored));
+    BOOST_CHECK(!fStored);
+    view.SequenceNumber = 301;
+    BOOST_CHECK(db.PutMutableDataIfNewer(data.vchInfoHash, view, fStored));
+    BOOST_CHECK(fStored);
+    CMutableData readData;
+    BOOST_CHECK(db.ReadMutableData(data.vchInfoHash, readData));
+    BOOST_CHECK_EQUAL(readData.SequenceNumber, 301);
+    BOOST_CHECK(readData.vchValue == data.vchValue);
+}
+
+BOOST_AUTO_TEST_CASE(dht_mutable_db_paging)
+{
+    CMutableDataDB db(1 << 20, true, false, false);
+    for (unsigned char i = 0; i < 5; i++) {
+        CMutableData data(CharString(20, i), CharString(32, 'a'), CharString(64, 'b'), i, vchFromString("salt"), vchFromString("value"));
+        BOOST_CHECK(db.AddMutableData(data));
+    }
+
+    std::vector<CMutableData> vPage;
+    std::vector<unsigned char> vchNext;
+    BOOST_CHECK(db.ListMutableData(std::vector<unsigned char>(), 2, vPage, vchNext));
+    BOOST_CHECK_EQUAL(vPage.size(), 2U);
+    BOOST_CHECK(vchNext == CharString(20, 2));
+    vPage.clear();
+    std::vector<unsigned char> vchLast;
+    BOOST_CHECK(db.ListMutableData(vchNext, 10, vPage, vchLast));
+    BOOST_CHECK_EQUAL(vPage.size(), 3U);
+    BOOST_CHECK(vchLast.empty());
+    BOOST_CHECK_EQUAL(vPage.back().SequenceNumber, 4);
+    // the same vector may be passed as start and next key
+    vPage.clear();
+    BOOST_CHECK(db.ListMutableData(vchNext, 2, vPage, vchNext));
+    BOOST_CHECK_EQUAL(vPage.size(), 2U);
+    BOOST_CHECK_EQUAL(vPage.front().SequenceNumber, 2);
+    BOOST_CHECK(vchNext == CharString(20, 4));
+
+    int nCount = 0;
+    BOOST_CHECK(db.ForEachMutableData([&nCount](const CMutableData& data) { return ++nCount < 3; }));
+    BOOST_CHECK_EQUAL(nCount, 3);
+
+    // the key index is loaded on first use and follows later writes
+    BOOST_CHECK_EQUAL(db.Size(), -1);
+    CMutableData randomItem;
+    BOOST_CHECK(db.SelectRandomMutableItem(randomItem));
+    BOOST_CHECK_EQUAL(db.Size(), 5);
+    BOOST_CHECK(db.EraseMutableData(CharString(20, 0)));
+    BOOST_CHECK_EQUAL(db.Size(), 4);
+    for (int i = 0; i < 20; i++) {
+        BOOST_CHECK(db.SelectRandomMutableItem(randomItem));
+        BOOST_CHECK(randomItem.vchInfoHash != CharString(20, 0));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
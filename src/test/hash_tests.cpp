@@ -2,7 +2,10 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "crypto/argon2d/lanepool.h"
+#include "crypto/argon2d/opt.h"
 #include "hash.h"
+#include "primitives/block.h"
 #include "utilstrencodings.h"
 #include "test/test_dynamic.h"
 
@@ -83,4 +86,106 @@ BOOST_AUTO_TEST_CASE(siphash)
     }*/
 }
 
+BOOST_AUTO_TEST_CASE(block_hash_memoization)
+{
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.hashPrevBlock = uint256S("0x1234");
+    header.nTime = 1500000000;
+    header.nBits = 0x1e0ffff0;
+
+    BlockHashCacheStats before = GetBlockHashCacheStats();
+    uint256 hash = header.GetHash();
+    BOOST_CHECK(hash == header.ComputeHash());
+    BOOST_CHECK(header.GetHash() == hash);
+    BlockHashCacheStats after = GetBlockHashCacheStats();
+    BOOST_CHECK_EQUAL(after.nMisses - before.nMisses, 1U);
+    BOOST_CHECK_EQUAL(after.nHits - before.nHits, 1U);
+
+    // Writing a header field must invalidate the memoized hash
+    header.nNonce += 1;
+    uint256 hashNonce = header.GetHash();
+    BOOST_CHECK(hashNonce != hash);
+    BOOST_CHECK(hashNonce == header.ComputeHash());
+
+    // Copies carry the memoized hash along
+    CBlock block(header);
+    BOOST_CHECK(block.GetHash() == hashNonce);
+    BOOST_CHECK(block.GetBlockHeader().GetHash() == hashNonce);
+    block.nNonce -= 1;
+    BOOST_CHECK(block.GetHash() == hash);
+
+    // Assignment copies the memoized hash too, so the copy is a cache hit
+    CBlockHeader copy;
+    copy = header;
+    before = GetBlockHashCacheStats();
+    BOOST_CHECK(copy.GetHash() == hashNonce);
+    after = GetBlockHashCacheStats();
+    BOOST_CHECK_EQUAL(after.nHits - before.nHits, 1U);
+    BOOST_CHECK_EQUAL(after.nMisses - before.nMisses, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(argon2d_nonce_batch)
+{
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.hashMerkleRoot = uint256S("0xabcd");
+    header.nTime = 1500000000;
+    header.nBits = 0x1e0ffff0;
+    header.nNonce = 0xfffffffc;
+
+    uint256 hashes[3];
+    BOOST_CHECK(header.ComputeHashes(3, hashes));
+    BOOST_CHECK_EQUAL(header.nNonce, 0xfffffffcU);
+    for (uint32_t i = 0; i < 3; i++) {
+        CBlockHeader single = header;
+        single.nNonce += i;
+        BOOST_CHECK(hashes[i] == single.ComputeHash());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(argon2d_kernels)
+{
+    // Every fill_segment kernel available on this machine must agree with the SSE2 baseline
+    std::vector<unsigned char> input(INPUT_BYTES);
+    for (size_t i = 0; i < input.size(); i++)
+        input[i] = i;
+
+    BOOST_CHECK_EQUAL(argon2d_select_impl("sse2"), ARGON2_OK);
+    uint256 hashPhase1 = hash_Argon2d(input.begin(), input.end(), 1);
+    uint256 hashPhase2 = hash_Argon2d(input.begin(), input.end(), 2);
+
+    for (const char* impl : {"avx2", "avx512f"}) {
+        if (argon2d_select_impl(impl) != ARGON2_OK)
+            continue;
+        BOOST_CHECK_EQUAL(argon2d_impl_name(), impl);
+        BOOST_CHECK(hash_Argon2d(input.begin(), input.end(), 1) == hashPhase1);
+        BOOST_CHECK(hash_Argon2d(input.begin(), input.end(), 2) == hashPhase2);
+    }
+    BOOST_CHECK_EQUAL(argon2d_select_impl("neon"), -1);
+    argon2d_autodetect();
+}
+
+BOOST_AUTO_TEST_CASE(argon2d_lane_pool)
+{
+    // Filling lanes on the worker pool must not change the hash
+    std::vector<unsigned char> input(INPUT_BYTES);
+    for (size_t i = 0; i < input.size(); i++)
+        input[i] = 0xff - i;
+
+    BOOST_CHECK_EQUAL(Argon2dLaneThreads(), 1U);
+    uint256 hashPhase1 = hash_Argon2d(input.begin(), input.end(), 1);
+    uint256 hashPhase2 = hash_Argon2d(input.begin(), input.end(), 2);
+
+    Argon2dLanePoolStart(3);
+    BOOST_CHECK_EQUAL(Argon2dLaneThreads(), 4U);
+    for (int i = 0; i < 3; i++) {
+        BOOST_CHECK(hash_Argon2d(input.begin(), input.end(), 1) == hashPhase1);
+        BOOST_CHECK(hash_Argon2d(input.begin(), input.end(), 2) == hashPhase2);
+    }
+    Argon2dLanePoolStop();
+    BOOST_CHECK_EQUAL(Argon2dLaneThreads(), 1U);
+    BOOST_CHECK(hash_Argon2d(input.begin(), input.end(), 1) == hashPhase1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
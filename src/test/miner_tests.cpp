@@ -19,6 +19,8 @@
 #include "utilstrencodings.h"
 
 #include "miner/impl/miner-gpu.h"
+#include "miner/internal/cpu-topology.h"
+#include "miner/internal/hash-rate-counter.h"
 
 #include "test/test_dynamic.h"
 
@@ -244,6 +246,46 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
     BOOST_CHECK(pblocktemplate = CreateNewBlock(chainparams, scriptPubKey));
     mempool.clear();
 
+    // mempool transactions are appended to a copy of the current template
+    BOOST_CHECK(pblocktemplate = CreateNewBlock(chainparams, scriptPubKey));
+    const size_t nTemplateTxs = pblocktemplate->block.vtx.size();
+    CBlockTemplate parentless(*pblocktemplate);
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig = CScript() << OP_1;
+    tx.vin[0].prevout.hash = txFirst[1]->GetHash();
+    tx.vin[0].prevout.n = 0;
+    tx.vout[0].nValue = 49000000000LL;
+    uint256 hashParent = tx.GetHash();
+    mempool.addUnchecked(hashParent, entry.Fee(1000000000LL).Time(GetTime()).SpendsCoinbase(true).FromTx(tx));
+    tx.vin[0].prevout.hash = hashParent;
+    tx.vout[0].nValue = 48000000000LL;
+    hash = tx.GetHash();
+    mempool.addUnchecked(hash, entry.Fee(1000000000LL).Time(GetTime()).SpendsCoinbase(false).FromTx(tx));
+    // the template skipping the mempool, published first on a new tip
+    BOOST_CHECK(pblocktemplate->block.vtx.size() == CreateNewBlock(chainparams, &scriptPubKey, false)->block.vtx.size());
+    // a child is not added before its parent
+    BOOST_CHECK(!AddToBlockTemplate(parentless, chainparams, chainActive.Tip(), hash));
+    BOOST_CHECK(AddToBlockTemplate(*pblocktemplate, chainparams, chainActive.Tip(), hashParent));
+    BOOST_CHECK(!AddToBlockTemplate(*pblocktemplate, chainparams, chainActive.Tip(), hashParent));
+    BOOST_CHECK(AddToBlockTemplate(*pblocktemplate, chainparams, chainActive.Tip(), hash));
+    BOOST_CHECK_EQUAL(pblocktemplate->block.vtx.size(), nTemplateTxs + 2);
+    BOOST_CHECK(pblocktemplate->block.vtx.back()->GetHash() == hash);
+    BOOST_CHECK(pblocktemplate->block.hashMerkleRoot == BlockMerkleRoot(pblocktemplate->block));
+    BOOST_CHECK_EQUAL(pblocktemplate->vTxFees.back(), 1000000000LL);
+    // a transaction spending an input the template already spends is not added
+    tx.vin[0].prevout.hash = txFirst[1]->GetHash();
+    tx.vout[0].nValue = 47000000000LL;
+    hash = tx.GetHash();
+    mempool.addUnchecked(hash, entry.Fee(1000000000LL).Time(GetTime()).SpendsCoinbase(true).FromTx(tx));
+    BOOST_CHECK(!AddToBlockTemplate(*pblocktemplate, chainparams, chainActive.Tip(), hash));
+    // nor is one paying less than the relay fee once the block reaches -blockminsize
+    tx.vin[0].prevout.hash = txFirst[2]->GetHash();
+    hash = tx.GetHash();
+    mempool.addUnchecked(hash, entry.Fee(0).Time(GetTime()).SpendsCoinbase(true).FromTx(tx));
+    BOOST_CHECK(!AddToBlockTemplate(*pblocktemplate, chainparams, chainActive.Tip(), hash));
+    BOOST_CHECK_EQUAL(pblocktemplate->block.vtx.size(), nTemplateTxs + 2);
+    mempool.clear();
+
     // coinbase in mempool, template creation fails
     tx.vin.resize(1);
     tx.vin[0].prevout.SetNull();
@@ -419,4 +461,45 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
     fCheckpointsEnabled = true;
 }
 
+BOOST_AUTO_TEST_CASE(cpu_placement)
+{
+    BOOST_CHECK(ParseCPUList("0-2,8, 10-11", 12) == std::vector<int>({0, 1, 2, 8, 10, 11}));
+    BOOST_CHECK(ParseCPUList("3-1", 12).empty());
+    BOOST_CHECK(ParseCPUList("a", 12).empty());
+    // CPU numbers at or above the limit are rejected before anything is allocated
+    BOOST_CHECK(ParseCPUList("0-11,12", 12).empty());
+    BOOST_CHECK(ParseCPUList("0-2000000000", 12).empty());
+    BOOST_CHECK(ParseCPUList("0-4000000000", 12).empty());
+
+    // Two nodes with two cores each, CPUs 4-7 are the SMT siblings of 0-3
+    std::vector<CPUInfo> cpus;
+    for (int cpu = 0; cpu < 8; cpu++)
+        cpus.push_back(CPUInfo{cpu, (cpu % 4) / 2, cpu % 4});
+    std::vector<int> order;
+    for (const CPUInfo& info : OrderCPUPlacement(cpus))
+        order.push_back(info.cpu);
+    BOOST_CHECK(order == std::vector<int>({0, 2, 1, 3, 4, 6, 5, 7}));
+}
+
+BOOST_AUTO_TEST_CASE(hash_rate_windows)
+{
+    SetMockTime(1000);
+    HashRateCounterRef parent = std::make_shared<HashRateCounter>();
+    HashRateCounterRef counter = parent->MakeChild();
+    counter->Increment(0); // starts the timer
+    counter->Increment(50);
+    SetMockTime(1001);
+    counter->Increment(70);
+    SetMockTime(1002);
+
+    BOOST_CHECK_EQUAL(counter->GetRate(1), 70.0);
+    // only two seconds of history so far
+    BOOST_CHECK_EQUAL(counter->GetRate(60), 60.0);
+    BOOST_CHECK_EQUAL(parent->GetRate(1), 70.0);
+
+    counter->Reset();
+    BOOST_CHECK_EQUAL(counter->GetRate(60), 0.0);
+    SetMockTime(0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
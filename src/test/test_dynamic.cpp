@@ -10,6 +10,7 @@
 #include "chainparams.h"
 #include "consensus/consensus.h"
 #include "consensus/validation.h"
+#include "crypto/argon2d/opt.h"
 #include "key.h"
 #include "validation.h"
 #include "miner/miner.h"
@@ -47,6 +48,7 @@ BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
         RandomInit();
         ECC_Start();
         ECC_Start_Stealth();
+        argon2d_autodetect();
         SetupEnvironment();
         SetupNetworking();
         fPrintToDebugLog = false; // don't want to write to debug.log file
@@ -14,7 +14,9 @@
 #include "ui_interface.h"
 #include "uint256.h"
 
+#include <atomic>
 #include <stdint.h>
+#include <thread>
 
 #include <boost/thread.hpp>
 
@@ -27,6 +29,7 @@ static const char DB_ADDRESSUNSPENTINDEX = 'u';
 static const char DB_TIMESTAMPINDEX = 's';
 static const char DB_SPENTINDEX = 'p';
 static const char DB_BLOCK_INDEX = 'b';
+static const char DB_BDAPTXINDEX = 'x';
 
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_FLAG = 'F';
@@ -220,6 +223,19 @@ bool CBlockTreeDB::WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos>
     return WriteBatch(batch);
 }
 
+bool CBlockTreeDB::ReadBDAPTxIndex(const uint256& txid, CDiskTxPos& pos)
+{
+    return Read(std::make_pair(DB_BDAPTXINDEX, txid), pos);
+}
+
+bool CBlockTreeDB::WriteBDAPTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> >& vect)
+{
+    CDBBatch batch(*this);
+    for (std::vector<std::pair<uint256, CDiskTxPos> >::const_iterator it = vect.begin(); it != vect.end(); it++)
+        batch.Write(std::make_pair(DB_BDAPTXINDEX, it->first), it->second);
+    return WriteBatch(batch);
+}
+
 bool CBlockTreeDB::ReadSpentIndex(CSpentIndexKey& key, CSpentIndexValue& value)
 {
     return Read(std::make_pair(DB_SPENTINDEX, key), value);
@@ -365,12 +381,58 @@ bool CBlockTreeDB::ReadFlag(const std::string& name, bool& fValue)
     return true;
 }
 
+/** Copy a loaded entry into mapBlockIndex and check its proof of work against the stored hash */
+static bool InsertDiskBlockIndex(const CDiskBlockIndex& diskindex, boost::function<CBlockIndex*(const uint256&)>& insertBlockIndex)
+{
+    CBlockIndex* pindexNew = insertBlockIndex(diskindex.GetBlockHash());
+    pindexNew->pprev = insertBlockIndex(diskindex.hashPrev);
+    pindexNew->nHeight = diskindex.nHeight;
+    pindexNew->nFile = diskindex.nFile;
+    pindexNew->nDataPos = diskindex.nDataPos;
+    pindexNew->nUndoPos = diskindex.nUndoPos;
+    pindexNew->nVersion = diskindex.nVersion;
+    pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+    pindexNew->nTime = diskindex.nTime;
+    pindexNew->nBits = diskindex.nBits;
+    pindexNew->nNonce = diskindex.nNonce;
+    pindexNew->nStatus = diskindex.nStatus;
+    pindexNew->nTx = diskindex.nTx;
+
+    // The stored hash is trusted here, -verifyindexpow re-hashes the headers in the background
+    if (!CheckProofOfWork(pindexNew->GetBlockHash(), pindexNew->nBits, Params().GetConsensus()))
+        return error("LoadBlockIndex(): CheckProofOfWork failed: %s", pindexNew->ToString());
+    return true;
+}
+
+/** Fill in the hash of entries written without one, spreading the Argon2d work over all cores */
+static void HashDiskBlockIndexes(std::vector<CDiskBlockIndex>& vIndex)
+{
+    std::atomic<size_t> nNext(0);
+    auto hasher = [&vIndex, &nNext]() {
+        for (size_t i = nNext++; i < vIndex.size(); i = nNext++)
+            vIndex[i].hash = vIndex[i].GetBlockHash();
+    };
+    std::vector<std::thread> vThreads;
+    size_t nThreads = std::min<size_t>(std::max(GetNumCores(), 1), vIndex.size());
+    for (size_t i = 1; i < nThreads; i++)
+        vThreads.emplace_back(hasher);
+    hasher();
+    for (std::thread& thread : vThreads)
+        thread.join();
+}
+
 bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex)
 {
+    int64_t nStart = GetTimeMillis();
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
 
     pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
 
+    // Entries without a stored hash need a full Argon2d hash of their header,
+    // collect them and hash them in parallel once the scan is done.
+    std::vector<CDiskBlockIndex> vUnhashed;
+    size_t nEntries = 0;
+
     // Load mapBlockIndex
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
@@ -379,23 +441,11 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
             CDiskBlockIndex diskindex;
             if (pcursor->GetValue(diskindex)) {
                 // Construct block index object
-                CBlockIndex* pindexNew = insertBlockIndex(diskindex.GetBlockHash());
-                pindexNew->pprev = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->nHeight = diskindex.nHeight;
-                pindexNew->nFile = diskindex.nFile;
-                pindexNew->nDataPos = diskindex.nDataPos;
-                pindexNew->nUndoPos = diskindex.nUndoPos;
-                pindexNew->nVersion = diskindex.nVersion;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->nTime = diskindex.nTime;
-                pindexNew->nBits = diskindex.nBits;
-                pindexNew->nNonce = diskindex.nNonce;
-                pindexNew->nStatus = diskindex.nStatus;
-                pindexNew->nTx = diskindex.nTx;
-
-                if (!CheckProofOfWork(pindexNew->GetBlockHash(), pindexNew->nBits, Params().GetConsensus()))
-                    return error("LoadBlockIndex(): CheckProofOfWork failed: %s", pindexNew->ToString());
-
+                if (diskindex.hash.IsNull())
+                    vUnhashed.push_back(diskindex);
+                else if (!InsertDiskBlockIndex(diskindex, insertBlockIndex))
+                    return false;
+                nEntries++;
                 pcursor->Next();
             } else {
                 return error("LoadBlockIndex() : failed to read value");
@@ -405,6 +455,15 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
         }
     }
 
+    if (!vUnhashed.empty()) {
+        HashDiskBlockIndexes(vUnhashed);
+        for (const CDiskBlockIndex& diskindex : vUnhashed) {
+            if (!InsertDiskBlockIndex(diskindex, insertBlockIndex))
+                return false;
+        }
+    }
+
+    LogPrintf("LoadBlockIndex(): loaded %u block index entries (%u hashed) in %dms\n", nEntries, vUnhashed.size(), GetTimeMillis() - nStart);
     return true;
 }
 
@@ -130,6 +130,8 @@ public:
     bool ReadReindexing(bool& fReindex);
     bool ReadTxIndex(const uint256& txid, CDiskTxPos& pos);
     bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> >& list);
+    bool ReadBDAPTxIndex(const uint256& txid, CDiskTxPos& pos);
+    bool WriteBDAPTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> >& list);
     bool ReadSpentIndex(CSpentIndexKey& key, CSpentIndexValue& value);
     bool UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >& vect);
     bool UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >& vect);
@@ -86,6 +86,7 @@ Mutex g_best_block_mutex;
 std::condition_variable g_best_block_cv;
 uint256 g_best_block;
 int nScriptCheckThreads = 0;
+int nPowLaneThreads = 1;
 std::atomic_bool fImporting(false);
 bool fReindex = false;
 bool fTxIndex = true;
@@ -997,8 +998,7 @@ bool AcceptToMemoryPoolWorker(CTxMemPool& pool, CValidationState& state, const C
                     return state.Invalid(false, REJECT_INVALID, "bdap-account-txn-get-previous-failed" + strErrorMessage);
                 }
                 CTransactionRef pPrevTx;
-                uint256 hashBlock;
-                if (!GetTransaction(prevEntry.txHash, pPrevTx, Params().GetConsensus(), hashBlock, true)) {
+                if (!GetPreviousTxRefById(prevEntry.txHash, pPrevTx)) {
                     return state.Invalid(false, REJECT_INVALID, "bdap-account-txn-get-previous-tx-failed" + strErrorMessage);
                 }
                 // Get current wallet address used for BDAP tx
@@ -1022,8 +1022,7 @@ bool AcceptToMemoryPoolWorker(CTxMemPool& pool, CValidationState& state, const C
                     return state.Invalid(false, REJECT_INVALID, "bdap-account-txn-get-previous-failed" + strErrorMessage);
                 }
                 CTransactionRef pPrevTx;
-                uint256 hashBlock;
-                if (!GetTransaction(prevEntry.txHash, pPrevTx, Params().GetConsensus(), hashBlock, true)) {
+                if (!GetPreviousTxRefById(prevEntry.txHash, pPrevTx)) {
                     return state.Invalid(false, REJECT_INVALID, "bdap-account-txn-get-previous-tx-failed" + strErrorMessage);
                 }
                 // Get current wallet address used for BDAP tx
@@ -2341,6 +2340,11 @@ static DisconnectResult DisconnectBlock(const CBlock& block, CValidationState& s
         }
     }
 
+    if (!fReindex && nCheckLevel >= 4 && !RestoreExpiredDomainEntries(pindex)) {
+        AbortNode(state, "Failed to restore expired BDAP entries");
+        return DISCONNECT_FAILED;
+    }
+
     return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
 }
 
@@ -2377,6 +2381,100 @@ void ThreadScriptCheck()
     scriptcheckqueue.Thread();
 }
 
+/** Closure representing the proof-of-work check of one block header. */
+class CHeaderPowCheck
+{
+private:
+    const CBlockHeader* pheader;
+    const Consensus::Params* pconsensusParams;
+
+public:
+    CHeaderPowCheck() : pheader(NULL), pconsensusParams(NULL) {}
+    CHeaderPowCheck(const CBlockHeader& headerIn, const Consensus::Params& consensusParamsIn) : pheader(&headerIn), pconsensusParams(&consensusParamsIn) {}
+
+    bool operator()()
+    {
+        // GetHash() memoizes the Argon2d hash in the header
+        return CheckProofOfWork(pheader->GetHash(), pheader->nBits, *pconsensusParams);
+    }
+
+    void swap(CHeaderPowCheck& check)
+    {
+        std::swap(pheader, check.pheader);
+        std::swap(pconsensusParams, check.pconsensusParams);
+    }
+};
+
+// Each check is a full Argon2d hash, so hand them out in small batches
+static CCheckQueue<CHeaderPowCheck> headercheckqueue(4);
+
+void ThreadHeaderCheck()
+{
+    RenameThread("dynamic-hdrcheck");
+    // headers are already spread over these threads
+    Argon2dLanePoolExcludeThread();
+    headercheckqueue.Thread();
+}
+
+bool CheckBlockHeadersPoW(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams)
+{
+    int64_t nTimeStart = GetTimeMicros();
+    std::vector<CHeaderPowCheck> vChecks;
+    vChecks.reserve(headers.size());
+    for (const CBlockHeader& header : headers)
+        vChecks.emplace_back(header, consensusParams);
+
+    bool fValid = true;
+    if (nScriptCheckThreads && headers.size() > 1) {
+        CCheckQueueControl<CHeaderPowCheck> control(&headercheckqueue);
+        control.Add(vChecks);
+        fValid = control.Wait();
+    } else {
+        for (CHeaderPowCheck& check : vChecks)
+            fValid = check() && fValid;
+    }
+    LogPrint("bench", "    - Verify %u header proofs of work: %.2fms\n", (unsigned)headers.size(), 0.001 * (GetTimeMicros() - nTimeStart));
+    return fValid;
+}
+
+void ThreadVerifyBlockIndexPoW(int nEntries)
+{
+    RenameThread("dynamic-idxpow");
+    int64_t nStart = GetTimeMillis();
+
+    std::vector<std::pair<uint256, CBlockHeader> > vEntries;
+    {
+        LOCK(cs_main);
+        int nMinHeight = (nEntries < 0 || pindexBestHeader == NULL) ? -1 : pindexBestHeader->nHeight - nEntries;
+        for (const auto& item : mapBlockIndex) {
+            if (item.second->nHeight > nMinHeight)
+                vEntries.emplace_back(item.first, item.second->GetBlockHeader());
+        }
+    }
+
+    // Work in small batches so headers sync is not held off the check queue for long
+    static const size_t nBatchSize = 128;
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    std::vector<CBlockHeader> vHeaders;
+    vHeaders.reserve(nBatchSize);
+    for (size_t nPos = 0; nPos < vEntries.size(); nPos += nBatchSize) {
+        boost::this_thread::interruption_point();
+        size_t nEnd = std::min(nPos + nBatchSize, vEntries.size());
+        vHeaders.clear();
+        for (size_t i = nPos; i < nEnd; i++)
+            vHeaders.push_back(vEntries[i].second);
+        CheckBlockHeadersPoW(vHeaders, consensusParams);
+        for (size_t i = nPos; i < nEnd; i++) {
+            if (vHeaders[i - nPos].GetHash() != vEntries[i].first) {
+                AbortNode(strprintf("Block index entry %s does not match its header", vEntries[i].first.ToString()),
+                    _("Corrupted block database detected. Please restart with -reindex."));
+                return;
+            }
+        }
+    }
+    LogPrintf("Verified the proof of work of %u block index entries in %dms\n", vEntries.size(), GetTimeMillis() - nStart);
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -2552,6 +2650,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     CDiskTxPos pos(pindex->GetBlockPos(), GetSizeOfCompactSize(block.vtx.size()));
     std::vector<std::pair<uint256, CDiskTxPos> > vPos;
     vPos.reserve(block.vtx.size());
+    std::vector<std::pair<uint256, CDiskTxPos> > vBDAPPos;
     blockundo.vtxundo.reserve(block.vtx.size() - 1);
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
@@ -2693,6 +2792,8 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         UpdateCoins(tx, view, i == 0 ? undoDummy : blockundo.vtxundo.back(), pindex->nHeight);
 
         vPos.push_back(std::make_pair(tx.GetHash(), pos));
+        if (tx.nVersion == BDAP_TX_VERSION)
+            vBDAPPos.push_back(vPos.back());
         pos.nTxOffset += ::GetSerializeSize(tx, SER_DISK, CLIENT_VERSION);
     }
     int64_t nTime3 = GetTimeMicros();
@@ -2863,6 +2964,12 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         if (!pblocktree->WriteTimestampIndex(CTimestampIndexKey(pindex->nTime, pindex->GetBlockHash())))
             return AbortNode(state, "Failed to write timestamp index");
 
+    if (!vBDAPPos.empty() && !pblocktree->WriteBDAPTxIndex(vBDAPPos))
+        return AbortNode(state, "Failed to write BDAP transaction index");
+
+    if (!ExpireDomainEntries(pindex))
+        return AbortNode(state, "Failed to expire BDAP entries");
+
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
 
@@ -89,6 +89,10 @@ static const unsigned int UNDOFILE_CHUNK_SIZE = 0x400000; // 4 MiB
 static const int MAX_SCRIPTCHECK_THREADS = 16;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** Maximum number of threads computing the Argon2d lanes of one block hash (block headers use 8 lanes) */
+static const int MAX_POWLANE_THREADS = 8;
+/** -powlanethreads default (threads per block hash during validation, 0 = auto, 1 = no concurrency) */
+static const int DEFAULT_POWLANE_THREADS = 0;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 128;
 /** Timeout in seconds during which a peer must stall block download progress before being disconnected. */
@@ -184,6 +188,7 @@ extern uint256 g_best_block;
 extern std::atomic_bool fImporting;
 extern bool fReindex;
 extern int nScriptCheckThreads;
+extern int nPowLaneThreads;
 extern bool fTxIndex;
 extern bool fIsBareMultisigStd;
 extern bool fRequireStandard;
@@ -230,6 +235,8 @@ static const unsigned int MIN_BLOCKS_TO_KEEP = 288;
 
 static const signed int DEFAULT_CHECKBLOCKS = 10;
 static const unsigned int DEFAULT_CHECKLEVEL = 3;
+/** Number of recent block index entries re-hashed in the background at startup (0 = none, -1 = all) */
+static const int DEFAULT_VERIFYINDEXPOW = 0;
 
 // Require that user allocate at least 1590MB for block & undo files (blk???.dat and rev???.dat)
 // At 4MB per block, 288 blocks = 1152MB.
@@ -261,6 +268,18 @@ bool ProcessNewBlock(const CChainParams& chainparams, const std::shared_ptr<cons
  */
 bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& block, CValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex = NULL);
 
+/**
+ * Check the proof of work of a batch of headers, spread over the header check
+ * threads. The Argon2d hashes are memoized in the headers, so the in-order
+ * checks of ProcessNewBlockHeaders and any later GetHash() calls do not
+ * recompute them. Call this without cs_main held.
+ *
+ * @param[in]   headers The headers to check
+ * @return False if at least one header has an invalid proof of work. The
+ *         offending header is reported by ProcessNewBlockHeaders.
+ */
+bool CheckBlockHeadersPoW(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams);
+
 /** Check whether enough disk space is available for an incoming block */
 bool CheckDiskSpace(uint64_t nAdditionalBytes = 0);
 /** Open a block file (blk?????.dat) */
@@ -279,6 +298,15 @@ bool LoadBlockIndex(const CChainParams& chainparams);
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the header proof-of-work checking thread */
+void ThreadHeaderCheck();
+/**
+ * Re-hash the headers of the block index entries within nEntries of the best
+ * header (all of them if negative) and compare against the hashes stored in
+ * the block tree database, which are trusted when the index is loaded.
+ * Aborts the node on a mismatch.
+ */
+void ThreadVerifyBlockIndexPoW(int nEntries);
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Format a string that describes several potential problems detected by the core.
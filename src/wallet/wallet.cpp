@@ -971,6 +971,9 @@ bool CWallet::EncryptWallet(const SecureString& strWalletPassphrase)
                 return false;
             }
             pwalletdbEncryption->WriteMasterKey(nMasterKeyMaxID, kMasterKey);
+            // saved link records are plaintext, drop them with the switch to an encrypted wallet
+            for (const uint256& linkID : GetLinkRecordIDs())
+                pwalletdbEncryption->EraseLinkRecord(linkID);
         }
 
         // must get current HD chain before EncryptKeys
@@ -1912,6 +1915,18 @@ bool CWallet::EraseLinkMessageInfo(const uint256& subjectID)
     return walletdb.EraseLinkMessageInfo(subjectID);
 }
 
+bool CWallet::WriteLinkRecord(const CLink& link)
+{
+    CWalletDB walletdb(strWalletFile);
+    return walletdb.WriteLinkRecord(link);
+}
+
+bool CWallet::EraseLinkRecord(const uint256& linkID)
+{
+    CWalletDB walletdb(strWalletFile);
+    return walletdb.EraseLinkRecord(linkID);
+}
+
 bool CWallet::IsHDEnabled()
 {
     CHDChain hdChainCurrent;
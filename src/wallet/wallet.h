@@ -89,6 +89,7 @@ bool AutoBackupWallet(CWallet* wallet, std::string strWalletFile, std::string& s
 class CAccountingEntry;
 class CBlockIndex;
 class CCoinControl;
+class CLink;
 class COutput;
 class CReserveKey;
 class CScript;
@@ -1339,6 +1340,8 @@ public:
 
     bool WriteLinkMessageInfo(const uint256& subjectID, const std::vector<unsigned char>& vchPubKey);
     bool EraseLinkMessageInfo(const uint256& subjectID);
+    bool WriteLinkRecord(const CLink& link);
+    bool EraseLinkRecord(const uint256& linkID);
 
     // Stealth Address Support
     bool GetStealthAddress(const CKeyID& keyid, CStealthAddress& sxAddr) const;
@@ -10,6 +10,7 @@
 #include "wallet/walletdb.h"
 
 #include "base58.h"
+#include "bdap/linkmanager.h"
 #include "bdap/linkstorage.h"
 #include "bdap/stealth.h"
 #include "bdap/utils.h"
@@ -653,6 +654,19 @@ bool ReadKeyValue(CWallet* pwallet, CDataStream& ssKey, CDataStream& ssValue, CW
 
             LoadLinkMessageInfo(SubjectID, vchPubKey);
 
+        } else if (strType == "linkrecord") {
+            uint256 linkID;
+            ssKey >> linkID;
+
+            // plaintext records are not kept in encrypted wallets, the link is rebuilt from its link storage on unlock
+            int nRecordVersion = 0;
+            ssValue >> nRecordVersion;
+            if (nRecordVersion == LINK_RECORD_VERSION && !pwallet->IsCrypted()) {
+                CLink link;
+                ssValue >> link;
+                LoadLinkRecord(link);
+            }
+
         } else if (strType == "stealth") {
             CKeyID keyID;
             ssKey >> keyID;
@@ -1122,6 +1136,19 @@ bool CWalletDB::EraseLinkMessageInfo(const uint256& subjectID)
     return Erase(std::make_pair(std::string("linkid"), subjectID)); 
 }
 
+// Stores the processed link so startup does not need to decrypt its link records again
+bool CWalletDB::WriteLinkRecord(const CLink& link)
+{
+    LogPrint("bdap", "%s -- linkID = %s\n", __func__, link.LinkID.ToString());
+    return Write(std::make_pair(std::string("linkrecord"), link.LinkID), std::make_pair(LINK_RECORD_VERSION, link));
+}
+
+bool CWalletDB::EraseLinkRecord(const uint256& linkID)
+{
+    LogPrint("bdap", "%s -- linkID = %s\n", __func__, linkID.ToString());
+    return Erase(std::make_pair(std::string("linkrecord"), linkID));
+}
+
 bool CWalletDB::WriteStealthAddress(const CStealthAddress& sxAddr)
 {
     return Write(std::make_pair(std::string("stealth"), sxAddr.GetSpendKeyID()), sxAddr);
@@ -20,6 +20,8 @@
 #include <vector>
 
 static const bool DEFAULT_FLUSHWALLET = true;
+//! Version written ahead of each "linkrecord" value, records with another version are skipped on load
+static const int LINK_RECORD_VERSION = 1;
 
 class CAccount;
 class CAccountingEntry;
@@ -27,6 +29,7 @@ class CKeyEd25519;
 struct CBlockLocator;
 class CKeyPool;
 class CEdKeyPool;
+class CLink;
 class CLinkStorage;
 class CMasterKey;
 class CScript;
@@ -160,6 +163,8 @@ public:
     bool EraseLink(const std::vector<unsigned char>& vchPubKey, const std::vector<unsigned char>& vchSharedKey);
     bool WriteLinkMessageInfo(const uint256& subjectID, const std::vector<unsigned char>& vchPubKey);
     bool EraseLinkMessageInfo(const uint256& subjectID);
+    bool WriteLinkRecord(const CLink& link);
+    bool EraseLinkRecord(const uint256& linkID);
 
     bool WriteStealthAddress(const CStealthAddress& sxAddr);
     bool WriteStealthKeyQueue(const CKeyID& keyId, const CStealthKeyQueueData& sxKeyMeta);